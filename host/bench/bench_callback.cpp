@@ -0,0 +1,120 @@
+/** @file bench_callback.cpp
+ * @brief Host benchmark: callback dispatch cost, std::function vs CallbackT
+ *
+ * Compares the former dispatch idiom, copying a std::function out of the
+ * callback table before calling it, with invoking the non-allocating
+ * CallbackT (InplaceFunction) in place. Lambdas with 8, 16 and 32 bytes of
+ * captured state are measured and the heap allocations per dispatch are
+ * counted by replacing the global operator new.
+ *
+ * Usage: bench_callback [iterations]
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+#include "esp32_touch.h"
+
+namespace
+{
+
+std::atomic<unsigned long> allocations{0};
+volatile unsigned long sink = 0;
+
+struct Capture8  {unsigned long a;};
+struct Capture16 {unsigned long a, b;};
+struct Capture32 {unsigned long a, b, c, d;};
+
+template<typename Capture>
+auto make_callback(const unsigned long seed)
+{
+    Capture capture{};
+    capture.a = seed;
+    return [capture](){sink = sink + capture.a;};
+}
+
+struct Result
+{
+    double ns;
+    double allocs;
+};
+
+template<typename Table>
+Result run_copy(const Table &table, const long iterations)
+{
+    const unsigned long allocs_before = allocations;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (long n=0; n<iterations; ++n) {
+        auto cb = table[n % TOUCH_PAD_MAX];
+        if (cb) cb();
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    return {std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations,
+            static_cast<double>(allocations - allocs_before) / iterations};
+}
+
+template<typename Table>
+Result run_in_place(const Table &table, const long iterations)
+{
+    const unsigned long allocs_before = allocations;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (long n=0; n<iterations; ++n) {
+        const auto &cb = table[n % TOUCH_PAD_MAX];
+        if (cb) cb();
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    return {std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations,
+            static_cast<double>(allocations - allocs_before) / iterations};
+}
+
+template<typename Capture>
+void bench(const char *name, const long iterations)
+{
+    std::function<void(void)> std_table[TOUCH_PAD_MAX];
+    CallbackT inplace_table[TOUCH_PAD_MAX];
+    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+        std_table[i] = make_callback<Capture>(i);
+        inplace_table[i] = make_callback<Capture>(i);
+    }
+    const Result before = run_copy(std_table, iterations);
+    const Result after = run_in_place(inplace_table, iterations);
+    std::printf("%-10s %-28s %10.2f %12.2f\n",
+                name, "std::function copy + call", before.ns, before.allocs);
+    std::printf("%-10s %-28s %10.2f %12.2f\n",
+                name, "CallbackT in place", after.ns, after.allocs);
+}
+
+} // anonymous namespace
+
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+int main(int argc, char *argv[])
+{
+    const long iterations = argc > 1 ? std::atol(argv[1]) : 10000000;
+    std::printf("# Callback dispatch cost, %ld dispatches per run\n", iterations);
+    std::printf("%-10s %-28s %10s %12s\n", "capture", "method", "ns/call", "allocs/call");
+    bench<Capture8>("8 bytes", iterations);
+    bench<Capture16>("16 bytes", iterations);
+    bench<Capture32>("32 bytes", iterations);
+    return 0;
+}
@@ -0,0 +1,98 @@
+/** @file bench_dispatch.cpp
+ * @brief Host benchmark: cost of one ESP32Touch dispatch cycle
+ *
+ * Runs the event loop against the simulated touch peripheral for 1 to 10
+ * enabled pads and a set of synthetic press patterns and reports the
+ * wall-clock time spent in ESP32Touch::updateButtons() per dispatch cycle,
+ * both for the default polling mode and the interrupt driven mode.
+ *
+ * Usage: bench_dispatch [cycles]
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "esp32_touch.h"
+#include "touch_sim.h"
+
+namespace
+{
+
+constexpr uint16_t idle_value = touch_sim::default_idle_value;
+constexpr uint16_t pressed_value = idle_value / 2;
+constexpr uint8_t threshold_percent = 80;
+
+enum Pattern {IDLE, HOLD, TAP, NUM_PATTERNS};
+const char *pattern_names[NUM_PATTERNS] = {"idle", "hold", "tap"};
+
+unsigned long callback_count = 0;
+
+/** Sensor value of a pad at time t_ms for the given press pattern */
+uint16_t pattern_value(const Pattern pattern, const int pad,
+                       const unsigned long t_ms)
+{
+    switch (pattern) {
+    case HOLD:
+        return pressed_value;
+    case TAP:
+        // 120 ms taps every 400 ms, staggered per pad
+        return (t_ms + 37 * pad) % 400 < 120 ? pressed_value : idle_value;
+    default:
+        return idle_value;
+    }
+}
+
+double run(const int num_pads, const Pattern pattern, const long cycles,
+           const bool use_interrupt)
+{
+    touch_sim::reset();
+    ESP32Touch touch;
+    touch.use_touch_interrupt = use_interrupt;
+    for (int pad=0; pad<num_pads; ++pad) {
+        for (int s=ESP32Touch::SHORT_PRESSED; s<ESP32Touch::NUM_STATES_DONT_USE; ++s) {
+            touch.configure_input(pad, threshold_percent,
+                                  [](){++callback_count;},
+                                  static_cast<ESP32Touch::BUTTON_STATE>(s),
+                                  ESP32Touch::RISE, false);
+        }
+    }
+    touch.begin();
+
+    using clock = std::chrono::steady_clock;
+    clock::duration busy{0};
+    callback_count = 0;
+    for (long n=0; n<cycles; ++n) {
+        for (int pad=0; pad<num_pads; ++pad) {
+            touch_sim::set_value(pad, pattern_value(pattern, pad, millis()));
+        }
+        touch_sim::step_ms(touch.dispatch_cycle_time_ms);
+        const auto t0 = clock::now();
+        touch.updateButtons();
+        busy += clock::now() - t0;
+    }
+    touch.disableAllButtons();
+    return std::chrono::duration<double, std::nano>(busy).count() / cycles;
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    const long cycles = argc > 1 ? std::atol(argv[1]) : 50000;
+    touch_sim::set_serial_output(false);
+
+    std::printf("# ESP32Touch dispatch cycle cost, %ld cycles per run\n", cycles);
+    std::printf("%-9s %-5s %-8s %12s %10s\n",
+                "mode", "pads", "pattern", "ns/cycle", "callbacks");
+    for (int irq=0; irq<2; ++irq) {
+        for (int p=0; p<NUM_PATTERNS; ++p) {
+            for (int pads=1; pads<=TOUCH_PAD_MAX; ++pads) {
+                const double ns = run(pads, static_cast<Pattern>(p), cycles, irq);
+                std::printf("%-9s %-5d %-8s %12.1f %10lu\n",
+                            irq ? "interrupt" : "polling",
+                            pads, pattern_names[p], ns, callback_count);
+            }
+        }
+    }
+    return 0;
+}
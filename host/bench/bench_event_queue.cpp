@@ -0,0 +1,175 @@
+/** @file bench_event_queue.cpp
+ * @brief Host benchmark: event queue hand-off from the event loop to an
+ *        application task, see ESP32Touch::configure_queued_input()
+ *
+ * A detached ESP32Touch instance is fed synthetic press and release
+ * samples of one pad from the main thread, which thus acts as the event
+ * loop. Each press queues one SHORT_PRESSED event. A consumer thread
+ * takes the events:
+ *
+ *  - "wake": one press at a time, the consumer blocks in waitEvent().
+ *    Reports the time from the start of the event loop cycle to the
+ *    return from waitEvent(), i.e. the semaphore (condition variable on
+ *    the host) wake-up latency.
+ *  - "poll" and "wait": presses as fast as possible, the consumer spins
+ *    on pollEvent() or blocks in waitEvent(). Reports the event
+ *    throughput, the events dropped because the queue was full and the
+ *    queue high-water mark.
+ *
+ * Usage: bench_event_queue [events]
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "esp32_touch.h"
+#include "touch_sim.h"
+
+namespace
+{
+
+using clock = std::chrono::steady_clock;
+
+constexpr int pad = 0;
+constexpr uint16_t idle_value = touch_sim::default_idle_value;
+constexpr uint16_t pressed_value = idle_value / 2;
+
+long long now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            clock::now().time_since_epoch()).count();
+}
+
+double percentile(const std::vector<double> &sorted, const double p)
+{
+    if (sorted.empty()) return 0;
+    const size_t i = std::min(sorted.size() - 1,
+                              static_cast<size_t>(p / 100 * sorted.size()));
+    return sorted[i];
+}
+
+/** @brief Event loop side: one pad, every press queues an event */
+class Producer
+{
+public:
+    Producer() {
+        touch.configure_queued_input(pad, 80, ESP32Touch::SHORT_PRESSED,
+                                     ESP32Touch::RISE, false);
+        touch.setPressDurations(pad, 0, 1000, 2000);
+        touch.setBaseline(pad, idle_value);
+        touch.beginDetached();
+        for (uint16_t &value : filtered) {
+            value = idle_value;
+        }
+    }
+
+    /** @brief One press and release, each in its own event loop cycle */
+    void press(std::atomic<long long> *cycle_start_ns = nullptr) {
+        feed(pressed_value, cycle_start_ns);
+        feed(idle_value, nullptr);
+    }
+
+    ESP32Touch touch;
+
+private:
+    uint16_t filtered[TOUCH_PAD_MAX];
+    uint32_t timestamp_ms = 0;
+
+    void feed(const uint16_t value, std::atomic<long long> *cycle_start_ns) {
+        filtered[pad] = value;
+        timestamp_ms += 10;
+        touch.feedFilterOutput(filtered, timestamp_ms);
+        if (cycle_start_ns) {
+            cycle_start_ns->store(now_ns());
+        }
+        touch.processQueuedSamples();
+    }
+};
+
+void run_wake(const long events)
+{
+    Producer producer;
+    std::atomic<long long> cycle_start_ns{0};
+    std::atomic<long> received{0};
+    std::vector<double> latencies_us;
+    latencies_us.reserve(events);
+    std::thread consumer([&]() {
+        ESP32Touch::TouchEvent event;
+        for (long n=0; n<events; ++n) {
+            if (!producer.touch.waitEvent(event, 1000)) {
+                std::fprintf(stderr, "wake: timeout\n");
+                break;
+            }
+            latencies_us.push_back((now_ns() - cycle_start_ns.load()) / 1e3);
+            received.store(n + 1, std::memory_order_release);
+        }
+    });
+    for (long n=0; n<events; ++n) {
+        producer.press(&cycle_start_ns);
+        // One event in flight at a time
+        while (received.load(std::memory_order_acquire) <= n) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    std::sort(latencies_us.begin(), latencies_us.end());
+    std::printf("%-5s %8ld events  wake-up p50 %7.1f us  p99 %7.1f us  max %8.1f us\n",
+                "wake", events, percentile(latencies_us, 50),
+                percentile(latencies_us, 99),
+                latencies_us.empty() ? 0 : latencies_us.back());
+}
+
+void run_throughput(const char *label, const long events, const bool blocking)
+{
+    Producer producer;
+    std::atomic<bool> done{false};
+    long received = 0;
+    std::thread consumer([&]() {
+        ESP32Touch::TouchEvent event;
+        for (;;) {
+            const bool got = blocking ? producer.touch.waitEvent(event, 10)
+                                      : producer.touch.pollEvent(event);
+            if (got) {
+                ++received;
+            } else if (done.load()) {
+                // Drained after the producer finished
+                break;
+            } else if (!blocking) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    const auto t0 = clock::now();
+    for (long n=0; n<events; ++n) {
+        producer.press();
+    }
+    done.store(true);
+    consumer.join();
+    const double seconds = std::chrono::duration<double>(clock::now() - t0).count();
+    std::printf("%-5s %8ld events  %6.2f M/s  received %8ld  dropped %8u  "
+                "high water %2u/%u\n",
+                label, events, seconds > 0 ? events / seconds / 1e6 : 0, received,
+                producer.touch.getEventQueueDropCount(),
+                producer.touch.getEventQueueHighWater(), ESP32TOUCH_EVENT_QUEUE_SIZE);
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    const long events = argc > 1 ? std::atol(argv[1]) : 200000;
+    if (events < 1) {
+        std::fprintf(stderr, "Usage: bench_event_queue [events]\n");
+        return 2;
+    }
+    touch_sim::reset();
+    touch_sim::set_serial_output(false);
+    run_wake(std::min(events, 20000L));
+    run_throughput("poll", events, false);
+    run_throughput("wait", events, true);
+    return 0;
+}
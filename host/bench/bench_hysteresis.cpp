@@ -0,0 +1,160 @@
+/** @file bench_hysteresis.cpp
+ * @brief Host benchmark: spurious callbacks from a finger resting near
+ *        the touch threshold, with and without hysteresis and debouncing
+ *
+ * Replays a noisy sensor trace of one pad through the simulated IIR filter
+ * and counts SHORT_PRESSED callbacks per touch event. The trace alternates
+ * short taps well below the threshold with a finger resting on the pad so
+ * that its readout wobbles around the press threshold, plus measurement
+ * noise throughout. Every tap and every resting period should produce
+ * exactly one callback; each additional callback and every callback
+ * outside an event is counted as spurious.
+ *
+ * The trace is synthesized from a fixed seed, so that all configurations
+ * see exactly the same input.
+ *
+ * Usage: bench_hysteresis [minutes]
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "esp32_touch.h"
+#include "touch_sim.h"
+
+namespace
+{
+
+constexpr int pad = 0;
+constexpr uint16_t idle_value = touch_sim::default_idle_value;
+constexpr uint8_t threshold_percent = 80;
+constexpr uint32_t sample_period_ms = 10;
+// One event cycle: idle, tap, idle, resting finger
+constexpr uint32_t idle_ms = 1000;
+constexpr uint32_t tap_ms = 250;
+constexpr uint32_t rest_ms = 1500;
+constexpr uint32_t cycle_ms = 2 * idle_ms + tap_ms + rest_ms;
+// Callbacks up to this long after an event still belong to it
+constexpr uint32_t attribution_slack_ms = 300;
+constexpr int noise_amplitude = 40;
+// Resting finger: slow wobble around the press threshold
+constexpr int wobble_amplitude = 20;
+constexpr uint32_t wobble_period_ms = 230;
+constexpr int rest_offset = 8;
+
+struct Event {
+    uint32_t start_ms;
+    uint32_t end_ms;
+};
+
+struct Trace {
+    std::vector<uint16_t> raw;
+    std::vector<Event> events;
+};
+
+struct Config {
+    const char *label;
+    uint8_t release_threshold_percent;
+    uint8_t press_debounce_samples;
+    uint8_t release_debounce_samples;
+};
+
+const Config configs[] = {
+    {"single threshold", 0, 1, 1},
+    {"hysteresis 80/88%", 88, 1, 1},
+    {"debounce 3/3", 0, 3, 3},
+    {"hysteresis+debounce", 88, 2, 2},
+};
+
+std::vector<uint32_t> callback_times;
+
+Trace make_trace(const uint32_t duration_ms)
+{
+    Trace trace;
+    uint32_t rng = 12345;
+    // Slightly below the press threshold, popping above it periodically
+    const int rest_value = idle_value * threshold_percent / 100 - rest_offset;
+    for (uint32_t t_ms=0; t_ms<duration_ms; t_ms+=sample_period_ms) {
+        rng = rng * 1664525u + 1013904223u;
+        const int noise = static_cast<int>(rng >> 16) % (2 * noise_amplitude + 1)
+                          - noise_amplitude;
+        const uint32_t phase_ms = t_ms % cycle_ms;
+        int value = idle_value;
+        if (phase_ms >= idle_ms && phase_ms < idle_ms + tap_ms) {
+            value = idle_value / 2;
+        } else if (phase_ms >= 2 * idle_ms + tap_ms) {
+            value = rest_value + static_cast<int>(
+                    wobble_amplitude * std::sin(2 * M_PI * t_ms / wobble_period_ms));
+        }
+        trace.raw.push_back(static_cast<uint16_t>(value + noise));
+        if (phase_ms == idle_ms || phase_ms == 2 * idle_ms + tap_ms) {
+            const uint32_t length = phase_ms == idle_ms ? tap_ms : rest_ms;
+            trace.events.push_back({t_ms, t_ms + length});
+        }
+    }
+    return trace;
+}
+
+void run(const Config &config, const Trace &trace)
+{
+    touch_sim::reset();
+    ESP32Touch touch;
+    touch.press_debounce_samples = config.press_debounce_samples;
+    touch.release_debounce_samples = config.release_debounce_samples;
+    touch.configure_input(pad, threshold_percent,
+                          [](){callback_times.push_back(millis());},
+                          ESP32Touch::SHORT_PRESSED, ESP32Touch::RISE, false,
+                          config.release_threshold_percent);
+    touch.begin();
+
+    callback_times.clear();
+    const uint32_t t0_ms = millis();
+    for (size_t n=0; n<trace.raw.size(); ++n) {
+        touch_sim::set_raw(pad, trace.raw[n]);
+        touch_sim::step_ms(sample_period_ms);
+        if ((n + 1) * sample_period_ms % touch.dispatch_cycle_time_ms == 0) {
+            touch.updateButtons();
+        }
+    }
+    touch.disableAllButtons();
+
+    unsigned long missed = 0;
+    unsigned long spurious = 0;
+    size_t c = 0;
+    for (const Event &event : trace.events) {
+        unsigned long n = 0;
+        for (; c < callback_times.size()
+               && callback_times[c] - t0_ms < event.end_ms + attribution_slack_ms; ++c) {
+            if (callback_times[c] - t0_ms >= event.start_ms) {
+                ++n;
+            } else {
+                ++spurious; // Phantom, during idle
+            }
+        }
+        missed += n == 0;
+        spurious += n > 1 ? n - 1 : 0;
+    }
+    spurious += callback_times.size() - c;
+    std::printf("%-20s %8zu %10zu %8lu %9lu\n", config.label,
+                trace.events.size(), callback_times.size(), missed, spurious);
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    const long minutes = argc > 1 ? std::atol(argv[1]) : 10;
+    touch_sim::set_serial_output(false);
+    const Trace trace = make_trace(minutes * 60 * 1000);
+
+    std::printf("# Noisy trace, %ld min, %d%% press threshold, "
+                "finger resting at the threshold +-%d counts\n",
+                minutes, threshold_percent, wobble_amplitude);
+    std::printf("%-20s %8s %10s %8s %9s\n",
+                "config", "events", "callbacks", "missed", "spurious");
+    for (const Config &config : configs) {
+        run(config, trace);
+    }
+    return 0;
+}
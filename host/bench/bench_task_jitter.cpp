@@ -0,0 +1,145 @@
+/** @file bench_task_jitter.cpp
+ * @brief Host benchmark: touch-to-callback latency and jitter,
+ *        polled event timer vs. dedicated dispatcher task
+ *
+ * Runs the simulator in real-time mode. A press generator thread touches
+ * pad 0 at random intervals while a simulated Arduino loop() does a random
+ * 0..30 ms amount of busy work per iteration, calling updateButtons() in
+ * between. The SHORT_PRESSED time is set to zero, so the callback is due
+ * with the first filter sample seeing the touch.
+ *
+ * In "ticker" mode, the event loop is driven by updateButtons() from loop().
+ * In "task" mode, it runs in the dispatcher task (a std::thread on the host)
+ * on a fixed 20 ms schedule, independent of loop(). In "task+irq" mode, the
+ * task additionally sleeps until woken by the (simulated) touch interrupt.
+ *
+ * When built with ESP32TOUCH_LATENCY_HISTOGRAM, the library's own
+ * latency histogram is reported as well.
+ *
+ * Usage: bench_task_jitter [seconds_per_mode]
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "esp32_touch.h"
+#include "touch_sim.h"
+
+namespace
+{
+
+using clock = std::chrono::steady_clock;
+
+constexpr uint16_t idle_value = touch_sim::default_idle_value;
+constexpr uint16_t pressed_value = idle_value / 2;
+
+std::mutex latency_mutex;
+std::vector<double> latencies_ms;
+std::atomic<long long> press_time_ns{0};
+
+double ms_since(const long long t_ns)
+{
+    const long long now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            clock::now().time_since_epoch()).count();
+    return (now_ns - t_ns) / 1e6;
+}
+
+void busy_wait(const std::chrono::microseconds duration)
+{
+    const auto until = clock::now() + duration;
+    while (clock::now() < until) {}
+}
+
+double percentile(const std::vector<double> &sorted, const double p)
+{
+    if (sorted.empty()) return 0;
+    const size_t i = std::min(sorted.size() - 1,
+                              static_cast<size_t>(p / 100 * sorted.size()));
+    return sorted[i];
+}
+
+void run(const bool use_task, const bool use_interrupt, const int seconds)
+{
+    touch_sim::reset();
+    touch_sim::set_realtime(true);
+    latencies_ms.clear();
+
+    ESP32Touch touch;
+    touch.use_touch_interrupt = use_interrupt;
+    touch.configure_input(0, 80, []() {
+        std::lock_guard<std::mutex> lock(latency_mutex);
+        latencies_ms.push_back(ms_since(press_time_ns));
+    }, ESP32Touch::SHORT_PRESSED, ESP32Touch::RISE, false);
+    touch.setPressDurations(0, 0, 300, 2000);
+    touch.begin();
+    if (use_task) {
+        touch.startDispatcherTask(5, 4096, 1);
+    }
+
+    std::atomic<bool> running{true};
+    std::thread presser([&]() {
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<int> gap_ms(60, 140);
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(gap_ms(rng)));
+            press_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    clock::now().time_since_epoch()).count();
+            touch_sim::set_value(0, pressed_value);
+            std::this_thread::sleep_for(std::chrono::milliseconds(80));
+            touch_sim::set_value(0, idle_value);
+        }
+    });
+
+    // Simulated Arduino loop() with a variable amount of application work
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<int> work_us(0, 30000);
+    const auto end = clock::now() + std::chrono::seconds(seconds);
+    while (clock::now() < end) {
+        busy_wait(std::chrono::microseconds(work_us(rng)));
+        touch.updateButtons();
+    }
+    running = false;
+    presser.join();
+    touch.stopDispatcherTask();
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+    std::printf("          internal histogram: n=%u p50<=%.2f p99<=%.2f max=%.2f ms\n",
+                touch.getLatencyCount(0),
+                touch.getLatencyPercentile_us(0, 50) / 1e3,
+                touch.getLatencyPercentile_us(0, 99) / 1e3,
+                touch.getLatencyMax_us(0) / 1e3);
+    touch.resetLatencyHistograms();
+#endif
+    touch.disableAllButtons();
+    touch_sim::set_realtime(false);
+
+    std::lock_guard<std::mutex> lock(latency_mutex);
+    std::vector<double> sorted = latencies_ms;
+    std::sort(sorted.begin(), sorted.end());
+    std::printf("%-9s %7zu %8.2f %8.2f %8.2f %8.2f\n",
+                use_task ? (use_interrupt ? "task+irq" : "task") : "ticker",
+                sorted.size(),
+                percentile(sorted, 0), percentile(sorted, 50),
+                percentile(sorted, 99), sorted.empty() ? 0 : sorted.back());
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    const int seconds = argc > 1 ? std::atoi(argv[1]) : 5;
+    touch_sim::set_serial_output(false);
+    std::printf("# Touch-to-callback latency in ms, loop() doing 0..30 ms of work,"
+                " 10 ms filter period, 20 ms dispatch cycle\n");
+    std::printf("%-9s %7s %8s %8s %8s %8s\n",
+                "mode", "presses", "min", "p50", "p99", "max");
+    run(false, false, seconds);
+    run(true, false, seconds);
+    run(true, true, seconds);
+    return 0;
+}
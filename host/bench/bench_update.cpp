@@ -0,0 +1,70 @@
+/** @file bench_update.cpp
+ * @brief Host microbenchmark: per-pad button state update cost
+ *
+ * All ten pads are held down in staggered 3 s press / 0.5 s release cycles,
+ * so that every pad continuously runs through the SHORT, MEDIUM and LONG
+ * press duration states. Reports the time spent in the event loop per
+ * processed filter sample and pad.
+ *
+ * Usage: bench_update [seconds_simulated]
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "esp32_touch.h"
+#include "touch_sim.h"
+
+namespace
+{
+
+constexpr uint16_t idle_value = touch_sim::default_idle_value;
+constexpr uint16_t pressed_value = idle_value / 2;
+constexpr unsigned long press_ms = 3000;
+constexpr unsigned long cycle_ms = 3500;
+
+unsigned long callback_count = 0;
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    const long seconds = argc > 1 ? std::atol(argv[1]) : 3600;
+    touch_sim::set_serial_output(false);
+
+    ESP32Touch touch;
+    for (int pad=0; pad<TOUCH_PAD_MAX; ++pad) {
+        for (int s=ESP32Touch::SHORT_PRESSED; s<ESP32Touch::NUM_STATES_DONT_USE; ++s) {
+            touch.configure_input(pad, 80, [](){++callback_count;},
+                                  static_cast<ESP32Touch::BUTTON_STATE>(s),
+                                  ESP32Touch::RISE, false);
+        }
+    }
+    touch.begin();
+
+    using clock = std::chrono::steady_clock;
+    clock::duration busy{0};
+    const unsigned long cycles = seconds * 1000 / touch.dispatch_cycle_time_ms;
+    const unsigned long samples_per_cycle = touch.dispatch_cycle_time_ms
+                                            / touch.filter_period;
+    for (unsigned long n=0; n<cycles; ++n) {
+        const unsigned long t_ms = millis();
+        for (int pad=0; pad<TOUCH_PAD_MAX; ++pad) {
+            const bool pressed = (t_ms + 350 * pad) % cycle_ms < press_ms;
+            touch_sim::set_value(pad, pressed ? pressed_value : idle_value);
+        }
+        touch_sim::step_ms(touch.dispatch_cycle_time_ms);
+        const auto t0 = clock::now();
+        touch.updateButtons();
+        busy += clock::now() - t0;
+    }
+    touch.disableAllButtons();
+
+    const double pad_updates = static_cast<double>(cycles)
+                               * samples_per_cycle * TOUCH_PAD_MAX;
+    std::printf("# Per-pad state update cost, %ld s simulated\n", seconds);
+    std::printf("pad updates: %.0f  callbacks: %lu  ns/pad update: %.2f\n",
+                pad_updates, callback_count,
+                std::chrono::duration<double, std::nano>(busy).count() / pad_updates);
+    return 0;
+}
@@ -0,0 +1,131 @@
+/** @file async_touch_example.cpp
+ * @brief Host example: touch input flows as C++20 coroutines (AsyncTouch)
+ *
+ * Two coroutines run on one ESP32Touch instance:
+ *
+ *  - A code lock: pad 4 starts code entry, then pads 5, 6, 5 must follow
+ *    with at most 1.5 s between touches. A wrong pad or a timeout starts
+ *    over, up to three attempts.
+ *  - A hold detector: waits for a LONG_PRESSED of pad 7.
+ *
+ * A scripted press sequence is played into the simulated touch sensor on
+ * the virtual clock, and every step of the flows is printed with its time.
+ * Both coroutines have returned at the end of the script.
+ *
+ * Usage: async_touch_example
+ */
+#include <cstdio>
+
+#include "async_touch.h"
+#include "esp32_touch.h"
+#include "touch_sim.h"
+
+namespace
+{
+
+constexpr int start_pad = 4;
+constexpr int code_pads[] = {5, 6, 5};
+constexpr int hold_pad = 7;
+constexpr uint16_t code_mask = 1u << start_pad | 1u << 5 | 1u << 6;
+constexpr uint32_t code_timeout_ms = 1500;
+constexpr int code_attempts = 3;
+constexpr uint8_t threshold_percent = 80;
+constexpr uint32_t end_ms = 12000;
+
+/** @brief One touch of the scripted sequence */
+struct Touch {
+    uint32_t start_ms;
+    int pad;
+    uint32_t duration_ms;
+};
+
+const Touch script[] = {
+    // Correct code
+    {500, start_pad, 120}, {1000, 5, 120}, {1600, 6, 120}, {2300, 5, 120},
+    // Wrong second digit
+    {3500, start_pad, 120}, {4000, 6, 120},
+    // Stops after the first digit: timeout
+    {5500, start_pad, 120}, {6000, 5, 120},
+    // Hold
+    {8500, hold_pad, 2500},
+};
+
+// Start of the script on the simulation clock
+unsigned long t0_ms = 0;
+
+unsigned long elapsed_ms()
+{
+    return millis() - t0_ms;
+}
+
+TouchTask code_lock(AsyncTouch &touch)
+{
+    for (int attempt=0; attempt<code_attempts; ++attempt) {
+        co_await touch.nextPress(start_pad);
+        std::printf("%6lu  lock: enter code\n", elapsed_ms());
+        bool open = true;
+        for (const int expected : code_pads) {
+            const AsyncTouch::Result result = co_await touch.anyPress(code_mask,
+                                                                      code_timeout_ms);
+            if (result.status == AsyncTouch::TIMED_OUT) {
+                std::printf("%6lu  lock: timeout\n", elapsed_ms());
+                open = false;
+                break;
+            }
+            if (!result || result.event.pad != expected) {
+                std::printf("%6lu  lock: wrong pad %u\n", elapsed_ms(), result.event.pad);
+                open = false;
+                break;
+            }
+            std::printf("%6lu  lock: pad %u ok\n", elapsed_ms(), result.event.pad);
+        }
+        if (open) {
+            std::printf("%6lu  lock: open\n", elapsed_ms());
+        }
+    }
+}
+
+TouchTask hold_detector(AsyncTouch &touch)
+{
+    const AsyncTouch::Result result = co_await touch.nextPress(hold_pad,
+                                                               ESP32Touch::LONG_PRESSED);
+    std::printf("%6lu  hold: pad %u held for %u ms\n", elapsed_ms(),
+                result.event.pad, result.event.press_duration_ms);
+}
+
+} // anonymous namespace
+
+int main()
+{
+    touch_sim::reset();
+    touch_sim::set_serial_output(false);
+    ESP32Touch touch;
+    AsyncTouch async_touch{touch};
+    for (const int pad : {start_pad, 5, 6}) {
+        async_touch.configure_input(pad, threshold_percent);
+    }
+    async_touch.configure_input(hold_pad, threshold_percent, ESP32Touch::LONG_PRESSED,
+                                ESP32Touch::RISE, false);
+    touch.begin();
+
+    // Both start running and stop at their first co_await
+    code_lock(async_touch);
+    hold_detector(async_touch);
+
+    t0_ms = millis();
+    const uint32_t cycle_ms = touch.dispatch_cycle_time_ms;
+    for (uint32_t t_ms=0; t_ms<end_ms; t_ms+=cycle_ms) {
+        for (const Touch &press : script) {
+            if (t_ms == press.start_ms) {
+                touch_sim::set_value(press.pad, touch_sim::default_idle_value / 2);
+            } else if (t_ms == press.start_ms + press.duration_ms) {
+                touch_sim::set_value(press.pad, touch_sim::default_idle_value);
+            }
+        }
+        touch_sim::step_ms(cycle_ms);
+        touch.updateButtons();
+    }
+    touch.disableAllButtons();
+    std::printf("%6lu  %d coroutines waiting\n", elapsed_ms(), async_touch.waiting());
+    return 0;
+}
@@ -0,0 +1,220 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <pthread.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+struct tskTaskControlBlock
+{
+    TaskFunction_t code;
+    void *parameters;
+    UBaseType_t priority;
+    BaseType_t core_id;
+    std::mutex mutex;
+    std::condition_variable notified;
+    uint32_t notify_count = 0;
+    bool deleted = false;
+};
+
+namespace
+{
+
+using clock = std::chrono::steady_clock;
+
+const clock::time_point tick_epoch = clock::now();
+thread_local TaskHandle_t current_task = nullptr;
+
+clock::time_point tick_time(const TickType_t ticks)
+{
+    return tick_epoch + std::chrono::milliseconds(ticks * portTICK_PERIOD_MS);
+}
+
+} // anonymous namespace
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode,
+                                   const char *const pcName,
+                                   const uint32_t usStackDepth,
+                                   void *const pvParameters,
+                                   UBaseType_t uxPriority,
+                                   TaskHandle_t *const pvCreatedTask,
+                                   const BaseType_t xCoreID)
+{
+    (void)usStackDepth;
+    if (!pvTaskCode || uxPriority >= configMAX_PRIORITIES) {
+        return pdFAIL;
+    }
+    TaskHandle_t task = new tskTaskControlBlock;
+    task->code = pvTaskCode;
+    task->parameters = pvParameters;
+    task->priority = uxPriority;
+    task->core_id = xCoreID;
+    if (pvCreatedTask) {
+        *pvCreatedTask = task;
+    }
+    std::thread thread([task]() {
+        current_task = task;
+        task->code(task->parameters);
+        // FreeRTOS tasks must not return, but be lenient on the host
+        vTaskDelete(nullptr);
+    });
+    if (pcName) {
+        char name[16] = {};
+        for (int i=0; i<15 && pcName[i]; ++i) name[i] = pcName[i];
+        pthread_setname_np(thread.native_handle(), name);
+    }
+    thread.detach();
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+    if (xTaskToDelete == nullptr || xTaskToDelete == current_task) {
+        delete current_task;
+        current_task = nullptr;
+        pthread_exit(nullptr);
+    }
+    // A std::thread cannot be killed: the suspended task ends itself, see
+    // vTaskSuspend(). It frees the control block, so notify under the lock.
+    std::lock_guard<std::mutex> lock(xTaskToDelete->mutex);
+    xTaskToDelete->deleted = true;
+    xTaskToDelete->notified.notify_all();
+}
+
+void vTaskSuspend(TaskHandle_t xTaskToSuspend)
+{
+    // Only self-suspension is supported, until deleted by another task
+    TaskHandle_t task = current_task;
+    if (!task || (xTaskToSuspend != nullptr && xTaskToSuspend != task)) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(task->mutex);
+        task->notified.wait(lock, [task]() {return task->deleted;});
+    }
+    vTaskDelete(nullptr);
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(
+            xTicksToDelay * portTICK_PERIOD_MS));
+}
+
+void vTaskDelayUntil(TickType_t *const pxPreviousWakeTime,
+                     const TickType_t xTimeIncrement)
+{
+    *pxPreviousWakeTime += xTimeIncrement;
+    // Returns at once if the wake time is already in the past
+    std::this_thread::sleep_until(tick_time(*pxPreviousWakeTime));
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            clock::now() - tick_epoch).count() / portTICK_PERIOD_MS;
+}
+
+TickType_t xTaskGetTickCountFromISR()
+{
+    return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return current_task;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit,
+                          TickType_t xTicksToWait)
+{
+    TaskHandle_t task = current_task;
+    if (!task) {
+        return 0;
+    }
+    std::unique_lock<std::mutex> lock(task->mutex);
+    auto pending = [task]() {return task->notify_count != 0;};
+    if (xTicksToWait == portMAX_DELAY) {
+        task->notified.wait(lock, pending);
+    } else {
+        task->notified.wait_for(lock, std::chrono::milliseconds(
+                xTicksToWait * portTICK_PERIOD_MS), pending);
+    }
+    const uint32_t count = task->notify_count;
+    if (count) {
+        task->notify_count = xClearCountOnExit ? 0 : count - 1;
+    }
+    return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+    {
+        std::lock_guard<std::mutex> lock(xTaskToNotify->mutex);
+        ++xTaskToNotify->notify_count;
+    }
+    xTaskToNotify->notified.notify_one();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify,
+                            BaseType_t *pxHigherPriorityTaskWoken)
+{
+    xTaskNotifyGive(xTaskToNotify);
+    if (pxHigherPriorityTaskWoken) {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *pxSemaphoreBuffer)
+{
+    // Created empty, as in FreeRTOS
+    return new (pxSemaphoreBuffer) QueueDefinition;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+    xSemaphore->~QueueDefinition();
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+    {
+        std::lock_guard<std::mutex> lock(xSemaphore->mutex);
+        if (xSemaphore->available) {
+            return pdFAIL;
+        }
+        xSemaphore->available = true;
+    }
+    xSemaphore->given.notify_one();
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore,
+                                 BaseType_t *pxHigherPriorityTaskWoken)
+{
+    const BaseType_t result = xSemaphoreGive(xSemaphore);
+    if (pxHigherPriorityTaskWoken) {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+    return result;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xTicksToWait)
+{
+    std::unique_lock<std::mutex> lock(xSemaphore->mutex);
+    auto available = [xSemaphore]() {return xSemaphore->available;};
+    if (xTicksToWait == portMAX_DELAY) {
+        xSemaphore->given.wait(lock, available);
+    } else if (!xSemaphore->given.wait_for(lock, std::chrono::milliseconds(
+                    xTicksToWait * portTICK_PERIOD_MS), available)) {
+        return pdFAIL;
+    }
+    xSemaphore->available = false;
+    return pdPASS;
+}
@@ -0,0 +1,505 @@
+#include "touch_sim.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#include <Arduino.h>
+
+namespace
+{
+// Same fixed-point IIR filter as ESP-IDF v3.x touch_pad.c
+constexpr uint32_t filter_factor = 4;
+constexpr uint32_t filter_shift = 4;
+constexpr uint32_t filter_round = 1u << (filter_shift - 1);
+
+std::atomic<uint64_t> sim_time_us{0};
+std::atomic<bool> serial_output{true};
+
+// Real-time mode: clock follows the host steady clock and the filter runs
+// in its own thread, like the esp_timer task on the ESP32
+std::atomic<bool> realtime{false};
+std::chrono::steady_clock::time_point realtime_epoch;
+std::thread filter_thread;
+std::atomic<bool> filter_thread_running{false};
+// Serializes sensor value updates against the filter period
+std::recursive_mutex sim_mutex;
+
+// Per-thread clock override, see set_thread_clock()
+thread_local touch_sim::ClockFn thread_clock = nullptr;
+thread_local void *thread_clock_context = nullptr;
+
+bool initialized = false;
+bool filter_running = false;
+uint32_t filter_period_us = 0;
+uint64_t next_filter_us = 0;
+filter_cb_t filter_cb = nullptr;
+
+bool pad_configured[TOUCH_PAD_MAX];
+uint16_t pad_threshold[TOUCH_PAD_MAX];
+touch_trigger_mode_t trigger_mode = TOUCH_TRIGGER_BELOW;
+intr_handler_t isr_fn = nullptr;
+void *isr_arg = nullptr;
+bool intr_enabled = false;
+uint32_t intr_status = 0;
+unsigned long isr_calls = 0;
+
+uint16_t raw_value[TOUCH_PAD_MAX];
+touch_sim::IirFilter filter[TOUCH_PAD_MAX];
+uint16_t filtered_value[TOUCH_PAD_MAX];
+
+bool valid_pad(const int pad)
+{
+    return pad >= 0 && pad < TOUCH_PAD_MAX;
+}
+
+void stop_filter_thread()
+{
+    if (filter_thread.joinable()) {
+        filter_thread_running = false;
+        filter_thread.join();
+    }
+}
+
+void start_filter_thread()
+{
+    stop_filter_thread();
+    filter_thread_running = true;
+    filter_thread = std::thread([]() {
+        auto next = std::chrono::steady_clock::now();
+        while (filter_thread_running.load(std::memory_order_relaxed)) {
+            next += std::chrono::microseconds(filter_period_us);
+            std::this_thread::sleep_until(next);
+            touch_sim::filter_step();
+        }
+    });
+}
+} // anonymous namespace
+
+HardwareSerial Serial;
+
+namespace touch_sim
+{
+
+void reset()
+{
+    stop_filter_thread();
+    std::lock_guard<std::recursive_mutex> lock(sim_mutex);
+    sim_time_us = 0;
+    realtime_epoch = std::chrono::steady_clock::now();
+    initialized = false;
+    filter_running = false;
+    filter_period_us = 0;
+    next_filter_us = 0;
+    filter_cb = nullptr;
+    trigger_mode = TOUCH_TRIGGER_BELOW;
+    isr_fn = nullptr;
+    isr_arg = nullptr;
+    intr_enabled = false;
+    intr_status = 0;
+    isr_calls = 0;
+    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+        pad_configured[i] = false;
+        pad_threshold[i] = 0;
+        set_value(i, default_idle_value);
+    }
+}
+
+void set_realtime(const bool enabled)
+{
+    if (!enabled) {
+        stop_filter_thread();
+    }
+    realtime_epoch = std::chrono::steady_clock::now()
+                     - std::chrono::microseconds(now_us());
+    realtime = enabled;
+    if (enabled && filter_running) {
+        start_filter_thread();
+    }
+}
+
+void set_thread_clock(ClockFn clock, void *context)
+{
+    thread_clock = clock;
+    thread_clock_context = context;
+}
+
+uint64_t now_us()
+{
+    if (thread_clock) {
+        return thread_clock(thread_clock_context);
+    }
+    if (realtime.load(std::memory_order_relaxed)) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - realtime_epoch).count();
+    }
+    return sim_time_us.load(std::memory_order_relaxed);
+}
+
+void advance_us(uint64_t us)
+{
+    sim_time_us.fetch_add(us, std::memory_order_relaxed);
+}
+
+void step_ms(uint32_t ms)
+{
+    if (realtime) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        return;
+    }
+    std::lock_guard<std::recursive_mutex> lock(sim_mutex);
+    const uint64_t target = now_us() + static_cast<uint64_t>(ms) * 1000;
+    while (filter_running && next_filter_us <= target) {
+        sim_time_us = next_filter_us;
+        next_filter_us += filter_period_us;
+        filter_step();
+    }
+    sim_time_us = target;
+}
+
+void set_raw(const int pad, const uint16_t value)
+{
+    if (valid_pad(pad)) {
+        std::lock_guard<std::recursive_mutex> lock(sim_mutex);
+        raw_value[pad] = value;
+    }
+}
+
+void set_value(const int pad, const uint16_t value)
+{
+    if (valid_pad(pad)) {
+        std::lock_guard<std::recursive_mutex> lock(sim_mutex);
+        raw_value[pad] = value;
+        filter[pad].reset(value);
+        filtered_value[pad] = value;
+    }
+}
+
+uint16_t filtered(const int pad)
+{
+    return valid_pad(pad) ? filtered_value[pad] : 0;
+}
+
+void IirFilter::reset(const uint16_t value)
+{
+    state = static_cast<uint32_t>(value) << filter_shift;
+}
+
+uint16_t IirFilter::step(const uint16_t raw_value)
+{
+    const uint32_t in = static_cast<uint32_t>(raw_value) << filter_shift;
+    state = (in + (filter_factor - 1) * state) / filter_factor;
+    return (state + filter_round) >> filter_shift;
+}
+
+void filter_step()
+{
+    std::lock_guard<std::recursive_mutex> lock(sim_mutex);
+    // Measurement done: hardware threshold comparison on the raw values
+    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+        if (!pad_configured[i] || pad_threshold[i] == 0) continue;
+        const bool triggered = trigger_mode == TOUCH_TRIGGER_BELOW
+                               ? raw_value[i] < pad_threshold[i]
+                               : raw_value[i] > pad_threshold[i];
+        if (triggered) {
+            intr_status |= 1u << i;
+        }
+    }
+    if (intr_enabled && isr_fn && intr_status) {
+        ++isr_calls;
+        isr_fn(isr_arg);
+    }
+    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+        filtered_value[i] = filter[i].step(raw_value[i]);
+    }
+    if (filter_cb) {
+        filter_cb(raw_value, filtered_value);
+    }
+}
+
+unsigned long isr_count()
+{
+    return isr_calls;
+}
+
+void set_serial_output(const bool enabled)
+{
+    serial_output = enabled;
+}
+
+} // namespace touch_sim
+
+//////// Arduino core stand-ins
+
+unsigned long millis()
+{
+    return static_cast<unsigned long>(touch_sim::now_us() / 1000);
+}
+
+unsigned long micros()
+{
+    return static_cast<unsigned long>(touch_sim::now_us());
+}
+
+void delay(uint32_t ms)
+{
+    touch_sim::step_ms(ms);
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if (!serial_output.load(std::memory_order_relaxed)) return 1;
+    return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    if (!serial_output.load(std::memory_order_relaxed)) return size;
+    return fwrite(buffer, 1, size, stdout);
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--) {
+        n += write(*buffer++);
+    }
+    return n;
+}
+
+size_t Print::print(const char *s)
+{
+    size_t len = 0;
+    while (s[len]) ++len;
+    return write(reinterpret_cast<const uint8_t *>(s), len);
+}
+
+size_t Print::print(char c)
+{
+    return write(static_cast<uint8_t>(c));
+}
+
+size_t Print::print(unsigned char n, int base)
+{
+    return printNumber(n, base);
+}
+
+size_t Print::print(int n, int base)
+{
+    return print(static_cast<long>(n), base);
+}
+
+size_t Print::print(unsigned int n, int base)
+{
+    return printNumber(n, base);
+}
+
+size_t Print::print(long n, int base)
+{
+    if (base == DEC && n < 0) {
+        return print('-') + printNumber(-static_cast<unsigned long>(n), DEC);
+    }
+    return printNumber(static_cast<unsigned long>(n), base);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+    return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", digits, n);
+    return print(buf);
+}
+
+size_t Print::println()
+{
+    return print("\r\n");
+}
+
+size_t Print::printNumber(unsigned long n, int base)
+{
+    char buf[8 * sizeof(long) + 1];
+    char *str = &buf[sizeof(buf) - 1];
+    *str = '\0';
+    if (base < 2) base = 10;
+    do {
+        const char c = n % base;
+        n /= base;
+        *--str = c < 10 ? c + '0' : c + 'A' - 10;
+    } while (n);
+    return print(str);
+}
+
+//////// ESP-IDF touch_pad driver stand-ins
+
+esp_err_t touch_pad_init()
+{
+    std::lock_guard<std::recursive_mutex> lock(sim_mutex);
+    initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_deinit()
+{
+    stop_filter_thread();
+    initialized = false;
+    filter_running = false;
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_config(touch_pad_t touch_num, uint16_t threshold)
+{
+    std::lock_guard<std::recursive_mutex> lock(sim_mutex);
+    if (!valid_pad(touch_num) || !initialized) return ESP_ERR_INVALID_ARG;
+    pad_configured[touch_num] = true;
+    pad_threshold[touch_num] = threshold;
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_read(touch_pad_t touch_num, uint16_t *touch_value)
+{
+    if (!valid_pad(touch_num) || !touch_value) return ESP_ERR_INVALID_ARG;
+    *touch_value = raw_value[touch_num];
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_read_raw_data(touch_pad_t touch_num, uint16_t *touch_value)
+{
+    return touch_pad_read(touch_num, touch_value);
+}
+
+esp_err_t touch_pad_read_filtered(touch_pad_t touch_num, uint16_t *touch_value)
+{
+    std::lock_guard<std::recursive_mutex> lock(sim_mutex);
+    if (!valid_pad(touch_num) || !touch_value) return ESP_ERR_INVALID_ARG;
+    if (!filter_running) return ESP_ERR_INVALID_STATE;
+    *touch_value = filtered_value[touch_num];
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_set_voltage(touch_high_volt_t refh,
+                                touch_low_volt_t refl,
+                                touch_volt_atten_t atten)
+{
+    (void)refh; (void)refl; (void)atten;
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_set_fsm_mode(touch_fsm_mode_t mode)
+{
+    return mode < TOUCH_FSM_MODE_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t touch_pad_set_thresh(touch_pad_t touch_num, uint16_t threshold)
+{
+    std::lock_guard<std::recursive_mutex> lock(sim_mutex);
+    if (!valid_pad(touch_num)) return ESP_ERR_INVALID_ARG;
+    pad_threshold[touch_num] = threshold;
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_get_thresh(touch_pad_t touch_num, uint16_t *threshold)
+{
+    if (!valid_pad(touch_num) || !threshold) return ESP_ERR_INVALID_ARG;
+    *threshold = pad_threshold[touch_num];
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_set_trigger_mode(touch_trigger_mode_t mode)
+{
+    if (mode >= TOUCH_TRIGGER_MAX) return ESP_ERR_INVALID_ARG;
+    trigger_mode = mode;
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_isr_register(intr_handler_t fn, void *arg)
+{
+    std::lock_guard<std::recursive_mutex> lock(sim_mutex);
+    if (!fn) return ESP_ERR_INVALID_ARG;
+    isr_fn = fn;
+    isr_arg = arg;
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_isr_deregister(intr_handler_t fn, void *arg)
+{
+    std::lock_guard<std::recursive_mutex> lock(sim_mutex);
+    if (fn != isr_fn || arg != isr_arg) return ESP_ERR_INVALID_STATE;
+    isr_fn = nullptr;
+    isr_arg = nullptr;
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_intr_enable()
+{
+    intr_enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_intr_disable()
+{
+    intr_enabled = false;
+    return ESP_OK;
+}
+
+uint32_t touch_pad_get_status()
+{
+    return intr_status;
+}
+
+esp_err_t touch_pad_clear_status()
+{
+    intr_status = 0;
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_filter_start(uint32_t filter_period_ms)
+{
+    if (filter_period_ms == 0) return ESP_ERR_INVALID_ARG;
+    filter_period_us = filter_period_ms * 1000;
+    if (!filter_running) {
+        next_filter_us = touch_sim::now_us() + filter_period_us;
+    }
+    filter_running = true;
+    if (realtime) {
+        start_filter_thread();
+    }
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_filter_stop()
+{
+    stop_filter_thread();
+    filter_running = false;
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_filter_delete()
+{
+    stop_filter_thread();
+    filter_running = false;
+    filter_cb = nullptr;
+    return ESP_OK;
+}
+
+esp_err_t touch_pad_set_filter_read_cb(filter_cb_t read_cb)
+{
+    // Serialized against a running filter period
+    std::lock_guard<std::recursive_mutex> lock(sim_mutex);
+    filter_cb = read_cb;
+    return ESP_OK;
+}
+
+namespace
+{
+// Power-on state: all pads idle
+struct SimPowerOn
+{
+    SimPowerOn() {touch_sim::reset();}
+} sim_power_on;
+} // anonymous namespace
@@ -0,0 +1,111 @@
+/** @file touch_sim.h
+ * @brief Simulated ESP32 touch sensor peripheral for the host build
+ *
+ * This implements the ESP-IDF touch_pad API declared in
+ * host/stubs/driver/touch_pad.h plus the millis()/micros() clock, and adds
+ * a control interface for driving synthetic or recorded sensor values
+ * through the library code.
+ *
+ * The clock is virtual: it only advances when step_ms() or advance_us()
+ * is called, which makes all runs deterministic and lets benchmarks and
+ * soak tests run simulated hours in seconds.
+ * Alternatively, set_realtime() makes the clock follow the host steady
+ * clock with the filter running in its own thread, for measurements
+ * together with real threads such as the FreeRTOS task stand-ins.
+ *
+ * Like the ESP-IDF filter, the simulated IIR filter runs every
+ * filter_period_ms once touch_pad_filter_start() was called and then
+ * calls the hook registered via touch_pad_set_filter_read_cb().
+ * 
+ * Each filter period is also treated as one hardware measurement cycle:
+ * every configured pad whose raw value is below its touch_pad_config() /
+ * touch_pad_set_thresh() threshold sets its status bit, and the handler
+ * registered with touch_pad_isr_register() is called if interrupts are
+ * enabled. This is the simulated ISR source for interrupt driven operation.
+ */
+#ifndef TOUCH_SIM_H
+#define TOUCH_SIM_H
+
+#include <stdint.h>
+#include <driver/touch_pad.h>
+
+namespace touch_sim
+{
+
+/** @brief Idle-state sensor readout used after reset() */
+constexpr uint16_t default_idle_value = 800;
+
+/** @brief IIR filter of one pad, the same fixed-point filter as the
+ *         ESP-IDF v3.x driver, run once per filter period
+ */
+struct IirFilter
+{
+    /** @brief Settle the filter output at value */
+    void reset(const uint16_t value);
+    /** @brief Filter one raw readout
+     * @return New filtered readout
+     */
+    uint16_t step(const uint16_t raw_value);
+
+    uint32_t state = 0;
+};
+
+/** @brief Restore power-on state: clock at zero, filter stopped,
+ *         all pads reading default_idle_value
+ */
+void reset();
+
+/** @brief Switch between virtual (default) and real-time clock.
+ * 
+ * In real-time mode the clock continues from its current value at the
+ * speed of the host steady clock, step_ms() just sleeps and the filter
+ * periods (and filter callbacks) run in a background thread.
+ */
+void set_realtime(const bool enabled);
+
+/** @brief Current simulation time in microseconds */
+uint64_t now_us();
+
+/** @brief Clock source, see set_thread_clock() */
+using ClockFn = uint64_t (*)(void *context);
+
+/** @brief Replace the clock (now_us(), millis() and micros()) for the
+ *         calling thread only, e.g. by the sample timestamps of a replayed
+ *         trace. Threads with their own clock can run independent
+ *         simulations concurrently. nullptr restores the shared clock.
+ */
+void set_thread_clock(ClockFn clock, void *context);
+
+/** @brief Advance the virtual clock without running the filter */
+void advance_us(uint64_t us);
+
+/** @brief Advance the virtual clock by ms milliseconds, running every
+ *         filter period (and filter callback) which elapses on the way
+ */
+void step_ms(uint32_t ms);
+
+/** @brief Set the raw (unfiltered) sensor readout of a touch pad.
+ *         The filtered value follows with the IIR filter time constant.
+ */
+void set_raw(const int pad, const uint16_t value);
+
+/** @brief Set raw and filtered readout at once, bypassing the IIR filter
+ *         settling time. Useful for deterministic press patterns.
+ */
+void set_value(const int pad, const uint16_t value);
+
+/** @brief Filtered readout as last reported to the filter callback */
+uint16_t filtered(const int pad);
+
+/** @brief Run one filter period immediately, calling the filter callback */
+void filter_step();
+
+/** @brief Number of times the registered touch ISR was called */
+unsigned long isr_count();
+
+/** @brief Enable or mute output of the Serial stand-in (default: enabled) */
+void set_serial_output(const bool enabled);
+
+} // namespace touch_sim
+
+#endif
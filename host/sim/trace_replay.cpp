@@ -0,0 +1,158 @@
+#include "trace_replay.h"
+
+#include <chrono>
+
+#include "touch_sim.h"
+
+namespace touch_sim
+{
+
+namespace
+{
+
+uint64_t frame_clock(void *context)
+{
+    return static_cast<uint64_t>(*static_cast<const uint32_t *>(context)) * 1000;
+}
+
+} // anonymous namespace
+
+std::vector<TraceReader::Frame> read_trace(const uint8_t *data, const size_t size)
+{
+    std::vector<TraceReader::Frame> frames;
+    TraceReader reader(data, size);
+    TraceReader::Frame frame;
+    while (reader.next(frame)) {
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+uint32_t recorded_filter_period_ms(const std::vector<TraceReader::Frame> &frames)
+{
+    // Shortest step, which skips over gaps from dropped frames
+    uint32_t period = 0;
+    for (size_t n=1; n<frames.size() && n<16; ++n) {
+        const uint32_t step = frames[n].timestamp_ms - frames[n - 1].timestamp_ms;
+        if (step && (!period || step < period)) {
+            period = step;
+        }
+    }
+    return period;
+}
+
+std::vector<TraceReader::Frame> refilter(const std::vector<TraceReader::Frame> &frames,
+                                         const unsigned decimation)
+{
+    std::vector<TraceReader::Frame> out;
+    if (frames.empty() || decimation < 1) {
+        return out;
+    }
+    out.reserve(frames.size() / decimation + 1);
+    IirFilter filter[TOUCH_PAD_MAX];
+    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+        filter[i].reset(frames.front().filtered_value[i]);
+    }
+    for (size_t n=0; n<frames.size(); n+=decimation) {
+        TraceReader::Frame frame = frames[n];
+        for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+            frame.filtered_value[i] = filter[i].step(frame.raw_value[i]);
+        }
+        out.push_back(frame);
+    }
+    return out;
+}
+
+ReplayResult replay(const std::vector<TraceReader::Frame> &recorded,
+                    const ReplayConfig &config)
+{
+    ReplayResult result;
+    const uint32_t recorded_period_ms = recorded_filter_period_ms(recorded);
+    std::vector<TraceReader::Frame> refiltered;
+    if (recorded_period_ms && config.filter_period_ms > recorded_period_ms) {
+        refiltered = refilter(recorded, config.filter_period_ms / recorded_period_ms);
+    }
+    const std::vector<TraceReader::Frame> &frames = refiltered.empty() ? recorded
+                                                                       : refiltered;
+    if (frames.empty()) {
+        return result;
+    }
+    const TraceReader::Frame &first = frames.front();
+    const uint16_t pad_mask = config.pad_mask ? config.pad_mask & first.pad_mask
+                                              : first.pad_mask;
+    uint32_t now_ms = first.timestamp_ms;
+    set_thread_clock(frame_clock, &now_ms);
+    {
+        ESP32Touch touch;
+        touch.baseline_tracking_shift = config.baseline_tracking_shift;
+        touch.press_debounce_samples = config.press_debounce_samples;
+        touch.release_debounce_samples = config.release_debounce_samples;
+        std::vector<ReplayEvent> &events = result.events;
+        for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+            if (!(pad_mask & (1u << i))) {
+                continue;
+            }
+            for (int s=ESP32Touch::SHORT_PRESSED; s<=ESP32Touch::LONG_PRESSED; ++s) {
+                const auto state = static_cast<ESP32Touch::BUTTON_STATE>(s);
+                const uint32_t *clock = &now_ms;
+                const ReplayEvent event{0, static_cast<uint8_t>(i), state, config.edge};
+                touch.configure_input(i, config.threshold_percent,
+                                      [&events, clock, event]() {
+                                          events.push_back(event);
+                                          events.back().timestamp_ms = *clock;
+                                      },
+                                      state, config.edge, false,
+                                      config.release_threshold_percent);
+            }
+            touch.setPressDurations(i, config.short_press_ms, config.medium_press_ms,
+                                    config.long_press_ms);
+            touch.setBaseline(i, first.filtered_value[i]);
+        }
+        touch.beginDetached();
+
+        const auto t0 = std::chrono::steady_clock::now();
+        const uint32_t cycle_ms = config.dispatch_cycle_time_ms;
+        uint32_t next_dispatch_ms = first.timestamp_ms;
+        for (const TraceReader::Frame &frame : frames) {
+            // Cycles due before this frame run first, so that no event is
+            // stamped earlier than the sample causing it. Wrap-around safe.
+            while (cycle_ms && static_cast<int32_t>(frame.timestamp_ms - next_dispatch_ms) > 0) {
+                now_ms = next_dispatch_ms;
+                touch.processQueuedSamples();
+                next_dispatch_ms += cycle_ms;
+            }
+            now_ms = frame.timestamp_ms;
+            touch.feedFilterOutput(frame.filtered_value, frame.timestamp_ms,
+                                   frame.raw_value);
+            if (!cycle_ms) {
+                touch.processQueuedSamples();
+            } else if (frame.timestamp_ms == next_dispatch_ms) {
+                touch.processQueuedSamples();
+                next_dispatch_ms += cycle_ms;
+            }
+        }
+        const auto t1 = std::chrono::steady_clock::now();
+        result.frames = frames.size();
+        result.seconds = std::chrono::duration<double>(t1 - t0).count();
+    }
+    set_thread_clock(nullptr, nullptr);
+    return result;
+}
+
+const char *state_name(const ESP32Touch::BUTTON_STATE state)
+{
+    switch (state) {
+    case ESP32Touch::NO_PRESS:
+        return "NO_PRESS";
+    case ESP32Touch::SHORT_PRESSED:
+        return "SHORT_PRESSED";
+    case ESP32Touch::MEDIUM_PRESSED:
+        return "MEDIUM_PRESSED";
+    case ESP32Touch::LONG_PRESSED:
+        return "LONG_PRESSED";
+    default:
+        return "?";
+    }
+}
+
+} // namespace touch_sim
@@ -0,0 +1,111 @@
+/** @file trace_replay.h
+ * @brief Deterministic replay of recorded sensor traces through the
+ *        ESP32Touch detection pipeline on the host
+ *
+ * Each frame of a TraceRecorder trace is fed into a detached ESP32Touch
+ * instance (see ESP32Touch::beginDetached()) and dispatched right away or
+ * on the next emulated event loop cycle.
+ * The clock seen by the library is the frame timestamp, injected via
+ * touch_sim::set_thread_clock(), so a replay runs as fast as the CPU
+ * allows and always produces the same event log. Replays in different
+ * threads are independent of each other.
+ */
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "esp32_touch.h"
+#include "trace_recorder.h"
+
+namespace touch_sim
+{
+
+/** @brief Detection settings for a replay */
+struct ReplayConfig
+{
+    /** @brief Pads to replay, 0 for all pads recorded in the trace */
+    uint16_t pad_mask = 0;
+    uint8_t threshold_percent = 80;
+    /** @brief 0 for no hysteresis, see ESP32Touch::configure_input() */
+    uint8_t release_threshold_percent = 0;
+    uint8_t press_debounce_samples = 1;
+    uint8_t release_debounce_samples = 1;
+    /** @brief 0 disables baseline tracking */
+    uint8_t baseline_tracking_shift = 12;
+    ESP32Touch::TRIGGER_MODE edge = ESP32Touch::RISE;
+    /** @brief Minimum press durations in ms, see
+     *         ESP32Touch::setPressDurations()
+     */
+    uint32_t short_press_ms = ESP32Touch::DEFAULT_PRESS_TIMES_MS[ESP32Touch::SHORT_PRESSED];
+    uint32_t medium_press_ms = ESP32Touch::DEFAULT_PRESS_TIMES_MS[ESP32Touch::MEDIUM_PRESSED];
+    uint32_t long_press_ms = ESP32Touch::DEFAULT_PRESS_TIMES_MS[ESP32Touch::LONG_PRESSED];
+    /** @brief Filter period in ms, a multiple of the recorded one, see
+     *         refilter(). 0 replays the recorded filter output. Shorter
+     *         periods also replay the recorded output, other periods are
+     *         rounded down to a multiple.
+     */
+    uint32_t filter_period_ms = 0;
+    /** @brief Event loop period in ms. Queued samples are dispatched
+     *         every dispatch_cycle_time_ms of trace time, so events are
+     *         timestamped when the user would see them.
+     *         0 dispatches every frame as soon as it is fed.
+     */
+    uint32_t dispatch_cycle_time_ms = 0;
+};
+
+/** @brief One user callback, as called by the library */
+struct ReplayEvent
+{
+    /** @brief Trace time of the callback: the timestamp of the sample
+     *         which caused it, or of the dispatch cycle which ran it
+     */
+    uint32_t timestamp_ms;
+    uint8_t pad;
+    ESP32Touch::BUTTON_STATE state;
+    ESP32Touch::TRIGGER_MODE edge;
+};
+
+struct ReplayResult
+{
+    std::vector<ReplayEvent> events;
+    unsigned long frames = 0;
+    /** @brief Host wall-clock time of the replay in seconds */
+    double seconds = 0;
+};
+
+/** @brief Decode a complete trace
+ * @return All frames from the first key frame on
+ */
+std::vector<TraceReader::Frame> read_trace(const uint8_t *data, const size_t size);
+
+/** @brief Filter period of a trace in ms, from its first frames */
+uint32_t recorded_filter_period_ms(const std::vector<TraceReader::Frame> &frames);
+
+/** @brief Emulate a longer filter period: keep every decimation-th frame
+ *         and run the simulated IIR filter (IirFilter) on its raw readout
+ *         to recompute the filtered readout.
+ */
+std::vector<TraceReader::Frame> refilter(const std::vector<TraceReader::Frame> &frames,
+                                         const unsigned decimation);
+
+/** @brief Replay frames through a new ESP32Touch instance.
+ *
+ * The baselines are taken from the filtered readout of the first frame,
+ * like the calibration in ESP32Touch::begin(). Every pad gets a callback
+ * for SHORT_PRESSED, MEDIUM_PRESSED and LONG_PRESSED, each of which logs
+ * one event.
+ *
+ * The frames are first refiltered if config.filter_period_ms is longer
+ * than the recorded filter period.
+ */
+ReplayResult replay(const std::vector<TraceReader::Frame> &frames,
+                    const ReplayConfig &config);
+
+/** @brief Name of a BUTTON_STATE, e.g. "SHORT_PRESSED" */
+const char *state_name(const ESP32Touch::BUTTON_STATE state);
+
+} // namespace touch_sim
+
+#endif
@@ -0,0 +1,23 @@
+/** @file Arduino.h
+ * @brief Host build stand-in for the parts of the Arduino core used by
+ *        this library. The clock is provided by the touch pad simulator,
+ *        see host/sim/touch_sim.h
+ */
+#ifndef HOST_STUB_ARDUINO_H
+#define HOST_STUB_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "HardwareSerial.h"
+
+#define F(string_literal) (string_literal)
+
+// Code placement attribute from esp_attr.h, meaningless on the host
+#define IRAM_ATTR
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+
+#endif
@@ -0,0 +1,57 @@
+/** @file HardwareSerial.h
+ * @brief Host build stand-in for the Arduino Print/HardwareSerial classes.
+ *
+ * Output goes to stdout and can be muted via touch_sim::set_serial_output()
+ * so that benchmarks do not measure the terminal.
+ */
+#ifndef HOST_STUB_HARDWARESERIAL_H
+#define HOST_STUB_HARDWARESERIAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+
+    size_t print(const char *s);
+    size_t print(char c);
+    size_t print(unsigned char n, int base = DEC);
+    size_t print(int n, int base = DEC);
+    size_t print(unsigned int n, int base = DEC);
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+
+    size_t println();
+    template<typename T>
+    size_t println(const T &value) {return print(value) + println();}
+    template<typename T>
+    size_t println(const T &value, int format) {
+        return print(value, format) + println();
+    }
+
+private:
+    size_t printNumber(unsigned long n, int base);
+};
+
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long baud) {(void)baud;}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,98 @@
+/** @file Ticker.h
+ * @brief Host build stand-in for https://github.com/sstaub/Ticker.git
+ *
+ * Same polling semantics as the original: the callback runs from within
+ * update() once the interval has elapsed on the millis()/micros() clock.
+ */
+#ifndef HOST_STUB_TICKER_H
+#define HOST_STUB_TICKER_H
+
+#include <functional>
+#include "Arduino.h"
+
+enum resolution_t {MICROS, MILLIS, MICROS_MICROS};
+
+enum status_t {STOPPED, RUNNING, PAUSED};
+
+typedef std::function<void(void)> fptr;
+
+class Ticker
+{
+public:
+    Ticker(fptr callback, uint32_t timer, uint32_t repeat = 0,
+           resolution_t resolution = MICROS)
+        : callback{callback}, timer{timer}, repeat{repeat},
+          resolution{resolution}
+    {}
+
+    void start() {
+        if (!callback) return;
+        lastTime = now();
+        enabled = true;
+        counts = 0;
+        status = RUNNING;
+    }
+
+    void resume() {
+        if (!callback) return;
+        lastTime = now() - diffTime;
+        if (status == STOPPED) counts = 0;
+        enabled = true;
+        status = RUNNING;
+    }
+
+    void stop() {
+        enabled = false;
+        counts = 0;
+        status = STOPPED;
+    }
+
+    void pause() {
+        diffTime = now() - lastTime;
+        enabled = false;
+        status = PAUSED;
+    }
+
+    void update() {
+        if (tick()) callback();
+    }
+
+    void interval(uint32_t timer) {this->timer = timer;}
+    uint32_t interval() {return timer;}
+    uint32_t elapsed() {return now() - lastTime;}
+    uint32_t remaining() {return timer - elapsed();}
+    status_t state() {return status;}
+    uint32_t counter() {return counts;}
+
+private:
+    uint32_t now() {
+        return resolution == MILLIS ? millis() : micros();
+    }
+
+    bool tick() {
+        if (!enabled) return false;
+        uint32_t currentTime = now();
+        if ((currentTime - lastTime) >= timer) {
+            lastTime = currentTime;
+            if (repeat - counts == 1 && counts != 0xFFFFFFFF) {
+                enabled = false;
+                status = STOPPED;
+            }
+            counts++;
+            return true;
+        }
+        return false;
+    }
+
+    fptr callback;
+    uint32_t timer;
+    uint32_t repeat;
+    resolution_t resolution;
+    bool enabled = false;
+    uint32_t lastTime = 0;
+    uint32_t diffTime = 0;
+    uint32_t counts = 0;
+    status_t status = STOPPED;
+};
+
+#endif
@@ -0,0 +1,109 @@
+/** @file driver/touch_pad.h
+ * @brief Host build stand-in for the ESP-IDF touch sensor driver API.
+ *
+ * Only the subset used by this library is declared here. The functions are
+ * implemented by the touch pad simulator in host/sim/touch_sim.cpp, which
+ * also provides the control interface for feeding sensor values.
+ */
+#ifndef HOST_STUB_DRIVER_TOUCH_PAD_H
+#define HOST_STUB_DRIVER_TOUCH_PAD_H
+
+#include <stdint.h>
+
+typedef int32_t esp_err_t;
+
+#define ESP_OK                  0
+#define ESP_FAIL                -1
+#define ESP_ERR_INVALID_ARG     0x102
+#define ESP_ERR_INVALID_STATE   0x103
+
+typedef enum {
+    TOUCH_PAD_NUM0 = 0,
+    TOUCH_PAD_NUM1,
+    TOUCH_PAD_NUM2,
+    TOUCH_PAD_NUM3,
+    TOUCH_PAD_NUM4,
+    TOUCH_PAD_NUM5,
+    TOUCH_PAD_NUM6,
+    TOUCH_PAD_NUM7,
+    TOUCH_PAD_NUM8,
+    TOUCH_PAD_NUM9,
+    TOUCH_PAD_MAX,
+} touch_pad_t;
+
+typedef enum {
+    TOUCH_HVOLT_KEEP = -1,
+    TOUCH_HVOLT_2V4 = 0,
+    TOUCH_HVOLT_2V5,
+    TOUCH_HVOLT_2V6,
+    TOUCH_HVOLT_2V7,
+    TOUCH_HVOLT_MAX,
+} touch_high_volt_t;
+
+typedef enum {
+    TOUCH_LVOLT_KEEP = -1,
+    TOUCH_LVOLT_0V5 = 0,
+    TOUCH_LVOLT_0V6,
+    TOUCH_LVOLT_0V7,
+    TOUCH_LVOLT_0V8,
+    TOUCH_LVOLT_MAX,
+} touch_low_volt_t;
+
+typedef enum {
+    TOUCH_HVOLT_ATTEN_KEEP = -1,
+    TOUCH_HVOLT_ATTEN_1V5 = 0,
+    TOUCH_HVOLT_ATTEN_1V,
+    TOUCH_HVOLT_ATTEN_0V5,
+    TOUCH_HVOLT_ATTEN_0V,
+    TOUCH_HVOLT_ATTEN_MAX,
+} touch_volt_atten_t;
+
+typedef enum {
+    TOUCH_FSM_MODE_TIMER = 0,
+    TOUCH_FSM_MODE_SW,
+    TOUCH_FSM_MODE_MAX,
+} touch_fsm_mode_t;
+
+typedef enum {
+    TOUCH_TRIGGER_BELOW = 0,
+    TOUCH_TRIGGER_ABOVE = 1,
+    TOUCH_TRIGGER_MAX,
+} touch_trigger_mode_t;
+
+typedef void (* intr_handler_t)(void *arg);
+
+typedef void (* filter_cb_t)(uint16_t *raw_value, uint16_t *filtered_value);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t touch_pad_init();
+esp_err_t touch_pad_deinit();
+esp_err_t touch_pad_config(touch_pad_t touch_num, uint16_t threshold);
+esp_err_t touch_pad_read(touch_pad_t touch_num, uint16_t *touch_value);
+esp_err_t touch_pad_read_raw_data(touch_pad_t touch_num, uint16_t *touch_value);
+esp_err_t touch_pad_read_filtered(touch_pad_t touch_num, uint16_t *touch_value);
+esp_err_t touch_pad_set_voltage(touch_high_volt_t refh,
+                                touch_low_volt_t refl,
+                                touch_volt_atten_t atten);
+esp_err_t touch_pad_set_fsm_mode(touch_fsm_mode_t mode);
+esp_err_t touch_pad_set_thresh(touch_pad_t touch_num, uint16_t threshold);
+esp_err_t touch_pad_get_thresh(touch_pad_t touch_num, uint16_t *threshold);
+esp_err_t touch_pad_set_trigger_mode(touch_trigger_mode_t mode);
+esp_err_t touch_pad_isr_register(intr_handler_t fn, void *arg);
+esp_err_t touch_pad_isr_deregister(intr_handler_t fn, void *arg);
+esp_err_t touch_pad_intr_enable();
+esp_err_t touch_pad_intr_disable();
+uint32_t touch_pad_get_status();
+esp_err_t touch_pad_clear_status();
+esp_err_t touch_pad_filter_start(uint32_t filter_period_ms);
+esp_err_t touch_pad_filter_stop();
+esp_err_t touch_pad_filter_delete();
+esp_err_t touch_pad_set_filter_read_cb(filter_cb_t read_cb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
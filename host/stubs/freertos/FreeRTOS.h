@@ -0,0 +1,32 @@
+/** @file freertos/FreeRTOS.h
+ * @brief Host build stand-in for the FreeRTOS base types and macros.
+ *
+ * Ticks are milliseconds of real (steady clock) time, independent of the
+ * virtual clock of the touch pad simulator.
+ */
+#ifndef HOST_STUB_FREERTOS_H
+#define HOST_STUB_FREERTOS_H
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdFAIL                  pdFALSE
+#define pdPASS                  pdTRUE
+
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ      1000
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(xTimeInMs) \
+    ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ) \
+                  / (TickType_t)1000U))
+
+#define configMAX_PRIORITIES    25
+
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
+
+#endif
@@ -0,0 +1,33 @@
+/** @file freertos/semphr.h
+ * @brief Host build stand-in for the FreeRTOS semaphore API.
+ *
+ * Only statically allocated binary semaphores are provided, implemented
+ * with a mutex and a condition variable. Implemented in
+ * host/sim/freertos_sim.cpp
+ */
+#ifndef HOST_STUB_FREERTOS_SEMPHR_H
+#define HOST_STUB_FREERTOS_SEMPHR_H
+
+#include <condition_variable>
+#include <mutex>
+
+#include "FreeRTOS.h"
+
+// Opaque in FreeRTOS, only its size matters there
+struct QueueDefinition
+{
+    std::mutex mutex;
+    std::condition_variable given;
+    bool available = false;
+};
+typedef struct QueueDefinition *SemaphoreHandle_t;
+typedef struct QueueDefinition StaticSemaphore_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *pxSemaphoreBuffer);
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore,
+                                 BaseType_t *pxHigherPriorityTaskWoken);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xTicksToWait);
+
+#endif
@@ -0,0 +1,111 @@
+/** @file test_async_touch.cpp
+ * @brief Host test: AsyncTouch awaiters and timeouts
+ *
+ * Runs short coroutines on the virtual clock, once with the polled event
+ * loop and once in interrupt driven mode, where no samples are dispatched
+ * while all pads are idle: an anyPress() timeout must expire on time
+ * without any touch, and a touch must resume the waiting coroutine with
+ * its event.
+ *
+ * Usage: test_async_touch
+ * Exit status is non-zero if any check fails.
+ */
+#include <cstdio>
+#include <cstdlib>
+
+#include "async_touch.h"
+#include "esp32_touch.h"
+#include "touch_sim.h"
+
+namespace
+{
+
+constexpr int pad = 3;
+constexpr uint8_t threshold_percent = 80;
+constexpr uint32_t timeout_ms = 500;
+
+int failed = 0;
+
+void check(const bool ok, const char *what)
+{
+    failed += !ok;
+    std::printf("%-48s %s\n", what, ok ? "ok" : "FAIL");
+}
+
+struct Outcome {
+    bool done = false;
+    AsyncTouch::Result result{AsyncTouch::BUSY, {}};
+    unsigned long resumed_ms = 0;
+};
+
+TouchTask wait_any(AsyncTouch &touch, Outcome &outcome)
+{
+    outcome.result = co_await touch.anyPress(1u << pad, timeout_ms);
+    outcome.resumed_ms = millis();
+    outcome.done = true;
+}
+
+/** @brief Start wait_any() at t0, touch the pad at touch_ms if non-zero,
+ *         and run the event loop until end_ms
+ */
+Outcome run(const bool interrupt_driven, const uint32_t touch_ms, const uint32_t end_ms,
+            unsigned long &t0_ms, uint32_t &cycle_ms)
+{
+    touch_sim::reset();
+    ESP32Touch touch;
+    touch.use_touch_interrupt = interrupt_driven;
+    AsyncTouch async_touch{touch};
+    async_touch.configure_input(pad, threshold_percent);
+    touch.begin();
+    // Let the calibration finish
+    cycle_ms = touch.dispatch_cycle_time_ms;
+    for (uint32_t t_ms=0; t_ms<1000; t_ms+=cycle_ms) {
+        touch_sim::step_ms(cycle_ms);
+        touch.updateButtons();
+    }
+    Outcome outcome;
+    t0_ms = millis();
+    wait_any(async_touch, outcome);
+    for (uint32_t t_ms=0; t_ms<end_ms; t_ms+=cycle_ms) {
+        if (touch_ms && t_ms == touch_ms) {
+            touch_sim::set_value(pad, touch_sim::default_idle_value / 2);
+        } else if (touch_ms && t_ms == touch_ms + 200) {
+            touch_sim::set_value(pad, touch_sim::default_idle_value);
+        }
+        touch_sim::step_ms(cycle_ms);
+        touch.updateButtons();
+    }
+    touch.disableAllButtons();
+    return outcome;
+}
+
+void check_mode(const bool interrupt_driven)
+{
+    const char *mode = interrupt_driven ? "interrupt" : "polled";
+    char what[64];
+    unsigned long t0_ms;
+    uint32_t cycle_ms;
+
+    Outcome outcome = run(interrupt_driven, 0, 2 * timeout_ms, t0_ms, cycle_ms);
+    const unsigned long waited_ms = outcome.resumed_ms - t0_ms;
+    std::printf("# %s: timed out after %lu ms\n", mode, waited_ms);
+    std::snprintf(what, sizeof(what), "%s: anyPress() times out idle", mode);
+    check(outcome.done && outcome.result.status == AsyncTouch::TIMED_OUT
+          && waited_ms >= timeout_ms && waited_ms <= timeout_ms + 2 * cycle_ms, what);
+
+    outcome = run(interrupt_driven, 100, 2 * timeout_ms, t0_ms, cycle_ms);
+    std::snprintf(what, sizeof(what), "%s: anyPress() resumes on a touch", mode);
+    check(outcome.done && outcome.result && outcome.result.event.pad == pad
+          && outcome.resumed_ms - t0_ms < timeout_ms, what);
+}
+
+} // anonymous namespace
+
+int main()
+{
+    touch_sim::set_serial_output(false);
+    check_mode(false);
+    check_mode(true);
+    std::printf("%s\n", failed ? "FAIL" : "PASS");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
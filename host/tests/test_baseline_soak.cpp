@@ -0,0 +1,143 @@
+/** @file test_baseline_soak.cpp
+ * @brief Host soak test: adaptive baseline tracking over days of drift
+ *
+ * Simulates several days of sensor drift (a daily sinusoid of +-25% of the
+ * idle readout, as caused by temperature and humidity, plus measurement
+ * noise) on one pad, with a 300 ms press at half the idle readout every
+ * ten minutes. Counts phantom SHORT_PRESSED callbacks (outside any press)
+ * and missed presses, once with baseline tracking enabled and once with
+ * the one-shot calibration only, for comparison.
+ *
+ * Usage: test_baseline_soak [days]
+ * Exit status is non-zero if the run with baseline tracking has any
+ * phantom or missed press.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "esp32_touch.h"
+#include "touch_sim.h"
+
+namespace
+{
+
+constexpr int pad = 0;
+constexpr int threshold_percent = 80;
+constexpr uint32_t cycle_ms = 20;
+constexpr uint32_t day_ms = 24ul * 3600 * 1000;
+constexpr uint32_t press_interval_ms = 10ul * 60 * 1000;
+constexpr uint32_t press_duration_ms = 300;
+// Callbacks up to this long after the end of a press still count as a hit
+constexpr uint32_t press_slack_ms = 200;
+constexpr double drift_amplitude = 0.25;
+constexpr int noise_amplitude = 8;
+
+struct Result {
+    unsigned long presses = 0;
+    unsigned long detected = 0;
+    unsigned long phantom = 0;
+    uint16_t min_threshold = UINT16_MAX;
+    uint16_t max_threshold = 0;
+};
+
+unsigned long callback_count;
+
+uint16_t idle_value(const uint32_t t_ms, uint32_t &rng)
+{
+    const double phase = 2 * M_PI * (t_ms % day_ms) / day_ms;
+    rng = rng * 1664525u + 1013904223u;
+    const int noise = static_cast<int>(rng >> 16) % (2 * noise_amplitude + 1)
+                      - noise_amplitude;
+    return static_cast<uint16_t>(touch_sim::default_idle_value
+                                 * (1 - drift_amplitude * std::sin(phase)) + noise);
+}
+
+Result run(const uint32_t days, const uint8_t tracking_shift)
+{
+    touch_sim::reset();
+    ESP32Touch touch;
+    touch.baseline_tracking_shift = tracking_shift;
+    touch.configure_input(pad, threshold_percent, [](){++callback_count;},
+                          ESP32Touch::SHORT_PRESSED, ESP32Touch::RISE, false);
+    touch.begin();
+
+    Result result;
+    uint32_t rng = 1;
+    // Press window currently being evaluated, and whether it was detected
+    uint32_t press_start_ms = 0;
+    bool in_press_window = false;
+    bool press_hit = false;
+    const uint32_t end_ms = days * day_ms;
+    while (millis() < end_ms) {
+        const uint32_t t_ms = millis();
+        const uint32_t since_press = t_ms % press_interval_ms;
+        // First press after one interval, so calibration sees an idle pad
+        const bool pressed = t_ms >= press_interval_ms
+                             && since_press < press_duration_ms;
+        if (pressed && !in_press_window) {
+            press_start_ms = t_ms;
+            in_press_window = true;
+            press_hit = false;
+            ++result.presses;
+        }
+        const uint16_t idle = idle_value(t_ms, rng);
+        touch_sim::set_raw(pad, pressed ? idle / 2 : idle);
+
+        touch_sim::step_ms(cycle_ms);
+        callback_count = 0;
+        touch.updateButtons();
+        if (callback_count) {
+            if (in_press_window) {
+                press_hit = true;
+            } else {
+                result.phantom += callback_count;
+            }
+        }
+        if (in_press_window
+                && millis() - press_start_ms >= press_duration_ms + press_slack_ms) {
+            in_press_window = false;
+            result.detected += press_hit;
+        }
+
+        const uint16_t threshold = touch.getBaseline(pad) * threshold_percent / 100;
+        if (threshold < result.min_threshold) result.min_threshold = threshold;
+        if (threshold > result.max_threshold) result.max_threshold = threshold;
+    }
+    touch.disableAllButtons();
+    return result;
+}
+
+void print_result(const char *label, const Result &result)
+{
+    std::printf("%-20s presses %6lu  detected %6lu  missed %6lu  phantom %6lu"
+                "  threshold %u..%u\n",
+                label, result.presses, result.detected,
+                result.presses - result.detected, result.phantom,
+                result.min_threshold, result.max_threshold);
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    const uint32_t days = argc > 1 ? std::atol(argv[1]) : 3;
+    touch_sim::set_serial_output(false);
+    std::printf("# %u simulated days, press every %u s\n",
+                days, press_interval_ms / 1000);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const Result tracked = run(days, ESP32Touch().baseline_tracking_shift);
+    const auto t1 = std::chrono::steady_clock::now();
+    const Result one_shot = run(days, 0);
+
+    print_result("baseline tracking", tracked);
+    print_result("one-shot calibration", one_shot);
+    std::printf("# %.1f s wall-clock per run\n",
+                std::chrono::duration<double>(t1 - t0).count());
+
+    const bool ok = tracked.phantom == 0 && tracked.detected == tracked.presses;
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,295 @@
+/** @file test_gestures.cpp
+ * @brief Host test: callback sequences of the gesture state machines
+ *
+ * Each case configures a fresh ESP32Touch instance, plays a scripted
+ * sequence of touches into the simulated sensor on the virtual clock and
+ * compares the callbacks called, in order, against the documented
+ * behaviour. Touches switch the pad readout between idle and half of it
+ * at once (touch_sim::set_value()), so the timing is exact to one event
+ * loop cycle.
+ *
+ * Usage: test_gestures
+ * Exit status is non-zero if any case fails.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "esp32_touch.h"
+#include "touch_sim.h"
+
+namespace
+{
+
+constexpr uint8_t threshold_percent = 80;
+constexpr uint32_t step_ms = 10;
+
+/** @brief One touch of a script, in ms from the start of the case */
+struct Touch {
+    int pad;
+    uint32_t start_ms;
+    uint32_t duration_ms;
+};
+
+/** @brief One callback, in ms from the start of the case */
+struct Event {
+    uint32_t t_ms;
+    const char *name;
+};
+
+struct Case {
+    const char *label;
+    void (*setup)(ESP32Touch &touch);
+    std::vector<Touch> script;
+    uint32_t duration_ms;
+    std::vector<const char *> expected;
+    /** @brief Optional check of the event timing */
+    bool (*check)(const std::vector<Event> &events);
+};
+
+std::vector<Event> events;
+unsigned long t0_ms;
+
+void log_event(const char *name)
+{
+    events.push_back({static_cast<uint32_t>(millis() - t0_ms), name});
+}
+
+void configure_short(ESP32Touch &touch, const int pad)
+{
+    touch.configure_input(pad, threshold_percent, [](){log_event("short");},
+                          ESP32Touch::SHORT_PRESSED, ESP32Touch::RISE, false);
+}
+
+void configure_medium(ESP32Touch &touch, const int pad)
+{
+    touch.configure_input(pad, threshold_percent, [](){log_event("medium");},
+                          ESP32Touch::MEDIUM_PRESSED, ESP32Touch::RISE, false);
+}
+
+// A nullptr callback replaces the registered one
+void setup_cleared(ESP32Touch &touch)
+{
+    configure_short(touch, 0);
+    touch.configure_input(0, threshold_percent, nullptr);
+}
+
+/////////////////////////////// Multi-tap ///////////////////////////////////
+
+void setup_double_tap(ESP32Touch &touch)
+{
+    configure_short(touch, 0);
+    touch.configure_multi_tap(0, 2, [](){log_event("double");});
+}
+
+void setup_double_tap_suppressed(ESP32Touch &touch)
+{
+    configure_short(touch, 0);
+    configure_medium(touch, 0);
+    touch.configure_multi_tap(0, 2, [](){log_event("double");}, true);
+}
+
+void setup_triple_tap(ESP32Touch &touch)
+{
+    configure_short(touch, 0);
+    touch.configure_multi_tap(0, 2, [](){log_event("double");}, true);
+    touch.configure_multi_tap(0, 3, [](){log_event("triple");}, true);
+}
+
+// The deferred single tap comes once the window after its release expired
+bool check_deferred_single_tap(const std::vector<Event> &events)
+{
+    return events.size() == 1
+           && events[0].t_ms >= 200 + ESP32Touch::DEFAULT_MULTI_TAP_WINDOW_MS;
+}
+
+///////////////////////////////// Chords ////////////////////////////////////
+
+void setup_chord(ESP32Touch &touch)
+{
+    configure_short(touch, 2);
+    configure_short(touch, 3);
+    configure_short(touch, 4);
+    touch.configure_chord(1u << 2 | 1u << 3 | 1u << 4, [](){log_event("chord234");});
+    touch.configure_chord(1u << 2 | 1u << 3, [](){log_event("chord23");});
+}
+
+////////////////////////////// Auto-repeat //////////////////////////////////
+
+constexpr uint32_t hold_start_ms = 100;
+constexpr uint32_t hold_ms = 2500;
+// Callbacks run in the event loop cycle after the sample reaching the
+// deadline, so they may come this much later than scheduled
+constexpr uint32_t repeat_slack_ms = 40;
+
+std::vector<uint16_t> repeat_numbers;
+
+void setup_repeat(ESP32Touch &touch)
+{
+    repeat_numbers.clear();
+    configure_short(touch, 1);
+    touch.configure_auto_repeat(1, [](uint16_t n) {
+        repeat_numbers.push_back(n);
+        log_event("repeat");
+    });
+}
+
+// Documented schedule with the default settings: first repeat after the
+// delay, then intervals shrinking by the acceleration down to the minimum
+std::vector<uint32_t> repeat_schedule_ms()
+{
+    std::vector<uint32_t> schedule;
+    uint32_t t_ms = ESP32Touch::DEFAULT_REPEAT_DELAY_MS;
+    uint32_t interval_ms = ESP32Touch::DEFAULT_REPEAT_INTERVAL_MS;
+    while (t_ms < hold_ms) {
+        schedule.push_back(hold_start_ms + t_ms);
+        t_ms += interval_ms;
+        const uint32_t step = interval_ms
+                              * ESP32Touch::DEFAULT_REPEAT_ACCELERATION_PERCENT / 100;
+        interval_ms = interval_ms - step > ESP32Touch::DEFAULT_REPEAT_MIN_INTERVAL_MS
+                      ? interval_ms - step : ESP32Touch::DEFAULT_REPEAT_MIN_INTERVAL_MS;
+    }
+    return schedule;
+}
+
+bool check_repeat_schedule(const std::vector<Event> &events)
+{
+    const std::vector<uint32_t> schedule = repeat_schedule_ms();
+    // The first event is the SHORT_PRESSED callback
+    if (events.size() != schedule.size() + 1 || repeat_numbers.size() != schedule.size()) {
+        return false;
+    }
+    for (size_t n=0; n<schedule.size(); ++n) {
+        const uint32_t t_ms = events[n + 1].t_ms;
+        if (std::strcmp(events[n + 1].name, "repeat") || repeat_numbers[n] != n + 1
+                || t_ms < schedule[n] || t_ms > schedule[n] + repeat_slack_ms) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Every press counts its repeats from 1
+bool check_repeat_restart(const std::vector<Event> &)
+{
+    return repeat_numbers == std::vector<uint16_t>{1, 1};
+}
+
+// The name sequence is checked by check_repeat_schedule()
+std::vector<const char *> repeat_names()
+{
+    std::vector<const char *> names(repeat_schedule_ms().size() + 1, "repeat");
+    names[0] = "short";
+    return names;
+}
+
+const Case cases[] = {
+    {"callback cleared with nullptr", setup_cleared,
+     {{0, 100, 200}}, 600,
+     {}, nullptr},
+    {"double tap", setup_double_tap,
+     {{0, 100, 100}, {0, 300, 100}}, 1000,
+     {"short", "short", "double"}, nullptr},
+    {"taps too far apart", setup_double_tap,
+     {{0, 100, 100}, {0, 800, 100}}, 1500,
+     {"short", "short"}, nullptr},
+    {"suppressed single tap", setup_double_tap_suppressed,
+     {{0, 100, 100}}, 1000,
+     {"short"}, check_deferred_single_tap},
+    {"suppressed double tap", setup_double_tap_suppressed,
+     {{0, 100, 100}, {0, 300, 100}}, 1000,
+     {"double"}, nullptr},
+    {"suppressed hold", setup_double_tap_suppressed,
+     {{0, 100, 600}}, 1200,
+     {"medium"}, nullptr},
+    {"triple tap", setup_triple_tap,
+     {{0, 100, 100}, {0, 300, 100}, {0, 500, 100}}, 1200,
+     {"triple"}, nullptr},
+    {"double tap with triple registered", setup_triple_tap,
+     {{0, 100, 100}, {0, 300, 100}}, 1200,
+     {"double"}, nullptr},
+    {"chord with 40 ms skew", setup_chord,
+     {{2, 100, 300}, {3, 140, 300}}, 800,
+     {"chord23"}, nullptr},
+    {"chord held, third pad added", setup_chord,
+     {{2, 100, 600}, {3, 120, 600}, {4, 400, 300}}, 1000,
+     {"chord23", "short"}, nullptr},
+    {"superset chord first", setup_chord,
+     {{2, 100, 300}, {3, 110, 300}, {4, 110, 300}}, 800,
+     {"chord234"}, nullptr},
+    {"chord pads too far apart", setup_chord,
+     {{2, 100, 400}, {3, 300, 400}}, 1000,
+     {"short", "short"}, nullptr},
+    {"single chord pad", setup_chord,
+     {{2, 100, 200}}, 600,
+     {"short"}, nullptr},
+    {"accelerating auto-repeat", setup_repeat,
+     {{1, hold_start_ms, hold_ms}}, 3000,
+     repeat_names(), check_repeat_schedule},
+    {"tap without repeat", setup_repeat,
+     {{1, 100, 200}}, 1000,
+     {"short"}, nullptr},
+    {"repeat count restarts", setup_repeat,
+     {{1, 100, 600}, {1, 1000, 600}}, 2000,
+     {"short", "repeat", "short", "repeat"}, check_repeat_restart},
+};
+
+std::vector<Event> run(const Case &test)
+{
+    touch_sim::reset();
+    events.clear();
+    ESP32Touch touch;
+    test.setup(touch);
+    touch.begin();
+    t0_ms = millis();
+    const uint32_t cycle_ms = touch.dispatch_cycle_time_ms;
+    for (uint32_t t_ms=0; t_ms<test.duration_ms; t_ms+=step_ms) {
+        for (const Touch &press : test.script) {
+            if (t_ms == press.start_ms) {
+                touch_sim::set_value(press.pad, touch_sim::default_idle_value / 2);
+            } else if (t_ms == press.start_ms + press.duration_ms) {
+                touch_sim::set_value(press.pad, touch_sim::default_idle_value);
+            }
+        }
+        touch_sim::step_ms(step_ms);
+        if ((t_ms + step_ms) % cycle_ms == 0) {
+            touch.updateButtons();
+        }
+    }
+    touch.disableAllButtons();
+    return events;
+}
+
+bool matches(const Case &test, const std::vector<Event> &log)
+{
+    if (log.size() != test.expected.size()) {
+        return false;
+    }
+    for (size_t n=0; n<log.size(); ++n) {
+        if (std::strcmp(log[n].name, test.expected[n])) {
+            return false;
+        }
+    }
+    return !test.check || test.check(log);
+}
+
+} // anonymous namespace
+
+int main()
+{
+    touch_sim::set_serial_output(false);
+    int failed = 0;
+    for (const Case &test : cases) {
+        const std::vector<Event> log = run(test);
+        const bool ok = matches(test, log);
+        failed += !ok;
+        std::printf("%-36s %s", test.label, ok ? "ok  " : "FAIL");
+        for (const Event &event : log) {
+            std::printf(" %s@%u", event.name, event.t_ms);
+        }
+        std::printf("\n");
+    }
+    std::printf("%s\n", failed ? "FAIL" : "PASS");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+/** @file test_slider.cpp
+ * @brief Host test: TouchSlider position engine
+ *
+ * Checks that out of range thresholds are rejected, by TouchSlider and
+ * by ESP32Touch::configure_slider(), and that an idle panel does not
+ * count as touched. Then sweeps a simulated finger along a four-pad
+ * slider and around a four-pad wheel and compares the reported position
+ * with the finger position.
+ *
+ * The finger is modelled as lowering the readout of each pad linearly
+ * with its distance, by half of the baseline directly above the pad and
+ * not at all from one pad pitch away.
+ *
+ * Usage: test_slider
+ * Exit status is non-zero if any check fails.
+ */
+#include <cstdio>
+#include <cstdlib>
+
+#include "esp32_touch.h"
+#include "touch_slider.h"
+#include "touch_sim.h"
+
+namespace
+{
+
+constexpr uint8_t pads[] = {2, 3, 4, 5};
+constexpr uint8_t num_pads = sizeof(pads);
+constexpr uint8_t threshold_percent = 90;
+constexpr uint16_t idle_value = touch_sim::default_idle_value;
+// Finger steps in position units, and the allowed position error
+constexpr int32_t sweep_step = 16;
+constexpr int32_t tolerance = 8;
+
+int failed = 0;
+
+void check(const bool ok, const char *what)
+{
+    failed += !ok;
+    std::printf("%-48s %s\n", what, ok ? "ok" : "FAIL");
+}
+
+/** @brief Pad readouts with the finger at position (in pad pitch units) */
+void finger_at(const int32_t position, const bool wheel, uint16_t *filtered)
+{
+    const int32_t range = num_pads * TouchSlider::PAD_PITCH;
+    for (int n=0; n<num_pads; ++n) {
+        int32_t d = position - n * TouchSlider::PAD_PITCH;
+        if (wheel) {
+            d = ((d % range) + range + range / 2) % range - range / 2;
+        }
+        d = d < 0 ? -d : d;
+        const int32_t coverage = d < TouchSlider::PAD_PITCH ? TouchSlider::PAD_PITCH - d : 0;
+        filtered[pads[n]] = static_cast<uint16_t>(
+                idle_value - idle_value / 2 * coverage / TouchSlider::PAD_PITCH);
+    }
+}
+
+bool idle_panel_untouched(const uint8_t percent)
+{
+    TouchSlider slider;
+    if (!slider.configure(pads, num_pads, false, percent)) {
+        return false;
+    }
+    uint16_t filtered[TOUCH_PAD_MAX];
+    uint16_t baseline[TOUCH_PAD_MAX];
+    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+        filtered[i] = baseline[i] = idle_value;
+    }
+    return !slider.update(filtered, baseline, 0) && !slider.current().touched;
+}
+
+/** @brief Largest position error of a sweep, or -1 if not touched */
+int32_t sweep(const bool wheel)
+{
+    TouchSlider slider;
+    slider.configure(pads, num_pads, wheel, threshold_percent);
+    uint16_t filtered[TOUCH_PAD_MAX] = {};
+    uint16_t baseline[TOUCH_PAD_MAX];
+    for (uint16_t &value : baseline) {
+        value = idle_value;
+    }
+    const int32_t range = num_pads * TouchSlider::PAD_PITCH;
+    const int32_t end = wheel ? range : (num_pads - 1) * TouchSlider::PAD_PITCH;
+    int32_t max_error = 0;
+    uint32_t timestamp_ms = 0;
+    for (int32_t position=0; position<=end; position+=sweep_step) {
+        finger_at(position, wheel, filtered);
+        timestamp_ms += 10;
+        if (!slider.update(filtered, baseline, timestamp_ms) || !slider.current().touched) {
+            return -1;
+        }
+        int32_t error = slider.current().position - position;
+        if (wheel) {
+            error = ((error % range) + range + range / 2) % range - range / 2;
+        }
+        error = error < 0 ? -error : error;
+        max_error = error > max_error ? error : max_error;
+    }
+    return max_error;
+}
+
+} // anonymous namespace
+
+int main()
+{
+    touch_sim::set_serial_output(false);
+    TouchSlider slider;
+    check(!slider.configure(pads, num_pads, false, 0), "threshold 0% rejected");
+    check(!slider.configure(pads, num_pads, false, 100), "threshold 100% rejected");
+    check(!slider.configure(pads, num_pads, false, 150), "threshold 150% rejected");
+    check(idle_panel_untouched(99), "idle panel untouched at 99%");
+    check(idle_panel_untouched(1), "idle panel untouched at 1%");
+    {
+        touch_sim::reset();
+        ESP32Touch touch;
+        check(!touch.configure_slider(pads, num_pads, [](const TouchSlider::State &) {},
+                                      false, 100),
+              "configure_slider() rejects 100%");
+        check(touch.configure_slider(pads, num_pads, [](const TouchSlider::State &) {},
+                                     false, threshold_percent),
+              "configure_slider() accepts 90%");
+    }
+
+    const int32_t slider_error = sweep(false);
+    std::printf("# slider sweep: max error %d\n", slider_error);
+    check(slider_error >= 0 && slider_error <= tolerance, "slider sweep follows the finger");
+    const int32_t wheel_error = sweep(true);
+    std::printf("# wheel sweep: max error %d\n", wheel_error);
+    check(wheel_error >= 0 && wheel_error <= tolerance, "wheel sweep follows the finger");
+
+    std::printf("%s\n", failed ? "FAIL" : "PASS");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
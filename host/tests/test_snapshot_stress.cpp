@@ -0,0 +1,104 @@
+/** @file test_snapshot_stress.cpp
+ * @brief Host stress test: filtered value snapshots are never torn
+ *
+ * A writer thread runs the simulated touch filter back-to-back, each period
+ * publishing one value for all pads which is derived from the timestamp.
+ * Reader threads concurrently take snapshots via
+ * ESP32Touch::getLatestSample() and check that every pad value belongs to
+ * the same filter period as the timestamp.
+ *
+ * Usage: test_snapshot_stress [duration_ms]
+ * Exit status is non-zero if any inconsistent snapshot was observed.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "esp32_touch.h"
+#include "touch_sim.h"
+
+namespace
+{
+
+constexpr int num_readers = 3;
+
+uint16_t value_for(const uint32_t timestamp_ms)
+{
+    return timestamp_ms % 50000 + 1;
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    const long duration_ms = argc > 1 ? std::atol(argv[1]) : 1000;
+    touch_sim::set_serial_output(false);
+
+    ESP32Touch touch;
+    for (int pad=0; pad<TOUCH_PAD_MAX; ++pad) {
+        touch.configure_input(pad, 80);
+    }
+    touch.begin();
+
+    std::atomic<bool> running{true};
+    std::atomic<unsigned long> writes{0};
+    std::atomic<unsigned long> reads{0};
+    std::atomic<unsigned long> torn{0};
+
+    std::thread writer([&]() {
+        uint32_t t_ms = 1;
+        while (running.load(std::memory_order_relaxed)) {
+            touch_sim::advance_us(1000);
+            for (int pad=0; pad<TOUCH_PAD_MAX; ++pad) {
+                touch_sim::set_value(pad, value_for(t_ms));
+            }
+            touch_sim::filter_step();
+            ++t_ms;
+            writes.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    std::vector<std::thread> readers;
+    for (int r=0; r<num_readers; ++r) {
+        readers.emplace_back([&]() {
+            unsigned long n = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                const ESP32Touch::Sample sample = touch.getLatestSample();
+                if (sample.timestamp_ms == 0) continue; // Nothing written yet
+                const uint16_t expected = value_for(sample.timestamp_ms);
+                for (int pad=0; pad<TOUCH_PAD_MAX; ++pad) {
+                    if (sample.filtered_value[pad] != expected) {
+                        torn.fetch_add(1, std::memory_order_relaxed);
+                        break;
+                    }
+                }
+                ++n;
+            }
+            reads.fetch_add(n, std::memory_order_relaxed);
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+    running = false;
+    writer.join();
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    touch.disableAllButtons();
+
+    std::printf("writes: %lu  reads: %lu  torn snapshots: %lu\n",
+                writes.load(), reads.load(), torn.load());
+    if (writes == 0 || reads == 0) {
+        std::printf("FAIL: no concurrent activity\n");
+        return EXIT_FAILURE;
+    }
+    if (torn != 0) {
+        std::printf("FAIL: inconsistent snapshots observed\n");
+        return EXIT_FAILURE;
+    }
+    std::printf("PASS\n");
+    return EXIT_SUCCESS;
+}
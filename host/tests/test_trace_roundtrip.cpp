@@ -0,0 +1,205 @@
+/** @file test_trace_roundtrip.cpp
+ * @brief Host test: TraceRecorder output decoded by TraceReader
+ *
+ * Records synthetic samples and checks that TraceReader returns them
+ * unchanged: the initial key frame, delta frames with differences of
+ * either sign up to the full 16 bit range (zigzag encoding), and the key
+ * frame that resynchronises the stream after the ring overflowed, with
+ * its count of dropped frames. Also decodes a capture starting in the
+ * middle of the stream and one truncated in the middle of a frame.
+ *
+ * Usage: test_trace_roundtrip
+ * Exit status is non-zero if any check fails.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "trace_recorder.h"
+#include "touch_sim.h"
+
+namespace
+{
+
+constexpr uint16_t pad_mask = 1u << 0 | 1u << 3 | 1u << 9;
+
+int failed = 0;
+
+void check(const bool ok, const char *what)
+{
+    failed += !ok;
+    std::printf("%-48s %s\n", what, ok ? "ok" : "FAIL");
+}
+
+class BufferPrint : public Print
+{
+public:
+    size_t write(uint8_t c) override {
+        bytes.push_back(c);
+        return 1;
+    }
+    size_t write(const uint8_t *buffer, size_t size) override {
+        bytes.insert(bytes.end(), buffer, buffer + size);
+        return size;
+    }
+    using Print::write;
+
+    std::vector<uint8_t> bytes;
+};
+
+/** @brief Deterministic test sample n, including extreme jumps */
+TraceReader::Frame sample(const uint32_t n)
+{
+    TraceReader::Frame frame = {};
+    frame.pad_mask = pad_mask;
+    // Irregular, sometimes large timestamp steps
+    frame.timestamp_ms = 1000 + n * 10 + (n % 7 == 0 ? n * 1000 : 0);
+    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+        if (!(pad_mask & (1u << i))) {
+            continue;
+        }
+        uint16_t raw = static_cast<uint16_t>(800 + (n * 37 + i * 11) % 23 - 11);
+        if (n % 5 == 1) {
+            raw = n % 2 ? UINT16_MAX : 0;
+        }
+        frame.raw_value[i] = raw;
+        frame.filtered_value[i] = static_cast<uint16_t>(raw / 2 + n);
+    }
+    return frame;
+}
+
+bool same(const TraceReader::Frame &a, const TraceReader::Frame &b)
+{
+    return a.timestamp_ms == b.timestamp_ms && a.pad_mask == b.pad_mask
+           && std::memcmp(a.raw_value, b.raw_value, sizeof(a.raw_value)) == 0
+           && std::memcmp(a.filtered_value, b.filtered_value, sizeof(a.filtered_value)) == 0;
+}
+
+std::vector<TraceReader::Frame> decode(const uint8_t *data, const size_t size)
+{
+    std::vector<TraceReader::Frame> frames;
+    TraceReader reader(data, size);
+    TraceReader::Frame frame;
+    while (reader.next(frame)) {
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+/** @brief Record frames, draining after each, and decode them again */
+bool roundtrip()
+{
+    constexpr uint32_t num_frames = 200;
+    std::unique_ptr<TraceRecorder> recorder(new TraceRecorder);
+    BufferPrint sink;
+    recorder->start(pad_mask);
+    for (uint32_t n=0; n<num_frames; ++n) {
+        const TraceReader::Frame frame = sample(n);
+        if (!recorder->record(frame.raw_value, frame.filtered_value, frame.timestamp_ms)) {
+            return false;
+        }
+        recorder->drain(sink);
+    }
+    const std::vector<TraceReader::Frame> frames = decode(sink.bytes.data(),
+                                                          sink.bytes.size());
+    if (frames.size() != num_frames || sink.bytes[4] != TraceRecorder::KEY_FRAME) {
+        return false;
+    }
+    for (uint32_t n=0; n<num_frames; ++n) {
+        if (!same(frames[n], sample(n)) || frames[n].dropped_before) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Overflow the ring, then drain and continue recording */
+bool overflow_resync()
+{
+    std::unique_ptr<TraceRecorder> recorder(new TraceRecorder);
+    BufferPrint sink;
+    recorder->start(pad_mask);
+    std::vector<uint32_t> recorded;
+    uint32_t n = 0;
+    uint32_t dropped = 0;
+    while (dropped < 3) {
+        const TraceReader::Frame frame = sample(n);
+        if (recorder->record(frame.raw_value, frame.filtered_value, frame.timestamp_ms)) {
+            recorded.push_back(n);
+        } else {
+            ++dropped;
+        }
+        ++n;
+    }
+    const size_t first_part = recorded.size();
+    recorder->drain(sink);
+    for (const uint32_t end=n+20; n<end; ++n) {
+        const TraceReader::Frame frame = sample(n);
+        if (!recorder->record(frame.raw_value, frame.filtered_value, frame.timestamp_ms)) {
+            return false;
+        }
+        recorded.push_back(n);
+        recorder->drain(sink);
+    }
+    if (recorder->dropped() != dropped) {
+        return false;
+    }
+    const std::vector<TraceReader::Frame> frames = decode(sink.bytes.data(),
+                                                          sink.bytes.size());
+    if (frames.size() != recorded.size()) {
+        return false;
+    }
+    for (size_t k=0; k<frames.size(); ++k) {
+        const uint32_t expected_dropped = k == first_part ? dropped : 0;
+        if (!same(frames[k], sample(recorded[k]))
+                || frames[k].dropped_before != expected_dropped) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief A capture starting mid-stream decodes from the next key frame,
+ *         one ending mid-frame up to the last complete frame
+ */
+bool partial_capture()
+{
+    std::unique_ptr<TraceRecorder> recorder(new TraceRecorder);
+    BufferPrint sink;
+    recorder->start(pad_mask);
+    size_t key_offset = 0;
+    for (uint32_t n=0; n<40; ++n) {
+        if (n == 20) {
+            // Starts a new key frame
+            recorder->start(pad_mask);
+            key_offset = sink.bytes.size() + 4;
+        }
+        const TraceReader::Frame frame = sample(n);
+        recorder->record(frame.raw_value, frame.filtered_value, frame.timestamp_ms);
+        recorder->drain(sink);
+    }
+    // Cut into the magic of the second stream
+    const size_t start = key_offset - 2;
+    const std::vector<TraceReader::Frame> tail = decode(sink.bytes.data() + start,
+                                                        sink.bytes.size() - start);
+    if (tail.size() != 20 || !same(tail.front(), sample(20)) || !same(tail.back(), sample(39))) {
+        return false;
+    }
+    const std::vector<TraceReader::Frame> truncated = decode(sink.bytes.data(),
+                                                             sink.bytes.size() - 1);
+    return !truncated.empty() && same(truncated.back(), sample(38));
+}
+
+} // anonymous namespace
+
+int main()
+{
+    touch_sim::set_serial_output(false);
+    check(roundtrip(), "key and delta frames round trip");
+    check(overflow_resync(), "key frame resyncs after overflow");
+    check(partial_capture(), "partial captures decode");
+    std::printf("%s\n", failed ? "FAIL" : "PASS");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
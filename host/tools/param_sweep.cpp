@@ -0,0 +1,621 @@
+/** @file param_sweep.cpp
+ * @brief Host tool: evaluate a grid of detection settings against a
+ *        corpus of labelled sensor traces
+ *
+ * Every combination of the swept settings is replayed (see
+ * touch_sim::replay()) against every trace, on all cores. The tasks, one
+ * per setting and trace, are spread over per-thread deques; a thread works
+ * from the back of its own deque and steals from the front of the others
+ * when it runs dry, so long traces do not leave cores idle at the end.
+ *
+ * A trace file trace.bin comes with ground truth in trace.bin.labels, one
+ * touch per line ('#' starts a comment):
+ *
+ *     pad start_ms end_ms
+ *
+ * A SHORT_PRESSED callback on the pad between start_ms and end_ms plus the
+ * match slack detects the touch, with latency callback time - start_ms.
+ * Unmatched SHORT_PRESSED callbacks are false positives and undetected
+ * touches are false negatives. Alternatively, -S synthesizes labelled
+ * traces with noise, baseline drift, presses of varying duration and
+ * depth, hovering fingers and single-sample spikes.
+ *
+ * Prints one CSV line per setting. Settings which no other setting beats
+ * in false negative rate, false positives per hour and mean latency at
+ * once are marked pareto=1.
+ *
+ * Usage: param_sweep [options] trace.bin...
+ *   -t list      press thresholds in percent (default 70,75,80,85,90)
+ *   -p list      filter periods in ms, multiples of the recorded period
+ *                (default 10,20,40)
+ *   -c list      dispatch cycle times in ms (default 10,20,50)
+ *   -s list      SHORT_PRESSED press times in ms (default 0,20,50,100)
+ *   -d list      press and release debounce samples (default 1,2)
+ *   -m ms        match slack after the end of a touch (default 300)
+ *   -j threads   worker threads (default: all cores)
+ *   -S count     use count synthetic traces instead of files
+ *   -L seconds   length of each synthetic trace (default 120)
+ *   -W prefix    also write the synthetic traces to prefix<n>.bin and
+ *                prefix<n>.bin.labels
+ *   -P           print the Pareto-optimal settings only
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "touch_sim.h"
+#include "trace_replay.h"
+
+namespace
+{
+
+struct Label
+{
+    uint8_t pad;
+    uint32_t start_ms;
+    uint32_t end_ms;
+};
+
+struct Trace
+{
+    std::string name;
+    std::vector<TraceReader::Frame> frames;
+    std::vector<Label> labels;
+};
+
+struct Setting
+{
+    touch_sim::ReplayConfig config;
+    uint8_t debounce_samples;
+};
+
+/** @brief Outcome of one setting on one trace */
+struct Score
+{
+    unsigned long touches = 0;
+    unsigned long false_positives = 0;
+    std::vector<uint32_t> latencies_ms;
+};
+
+struct Summary
+{
+    unsigned long touches = 0;
+    unsigned long detected = 0;
+    unsigned long false_positives = 0;
+    double hours = 0;
+    double fn_rate = 0;
+    double fp_per_hour = 0;
+    double latency_mean_ms = 0;
+    uint32_t latency_p50_ms = 0;
+    uint32_t latency_p95_ms = 0;
+    bool pareto = false;
+};
+
+void usage()
+{
+    std::fprintf(stderr, "Usage: param_sweep [-t list] [-p list] [-c list] [-s list] "
+                         "[-d list] [-m ms] [-j threads] [-S count] [-L seconds] "
+                         "[-W prefix] [-P] [trace.bin...]\n");
+    std::exit(2);
+}
+
+std::vector<uint32_t> parse_list(const char *arg)
+{
+    std::vector<uint32_t> values;
+    char *end;
+    do {
+        values.push_back(std::strtoul(arg, &end, 10));
+        if (end == arg || (*end && *end != ',')) {
+            usage();
+        }
+        arg = end + 1;
+    } while (*end);
+    return values;
+}
+
+bool read_file(const std::string &path, std::vector<uint8_t> &data)
+{
+    FILE *in = std::fopen(path.c_str(), "rb");
+    if (!in) {
+        std::perror(path.c_str());
+        return false;
+    }
+    uint8_t chunk[4096];
+    size_t size;
+    while ((size = std::fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        data.insert(data.end(), chunk, chunk + size);
+    }
+    std::fclose(in);
+    return true;
+}
+
+bool read_labels(const std::string &path, std::vector<Label> &labels)
+{
+    FILE *in = std::fopen(path.c_str(), "r");
+    if (!in) {
+        std::perror(path.c_str());
+        return false;
+    }
+    char line[256];
+    int line_number = 0;
+    bool ok = true;
+    while (std::fgets(line, sizeof(line), in)) {
+        ++line_number;
+        char *comment = std::strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+        unsigned pad;
+        unsigned long start_ms, end_ms;
+        char rest;
+        const int fields = std::sscanf(line, "%u %lu %lu %c", &pad, &start_ms,
+                                       &end_ms, &rest);
+        if (fields <= 0) {
+            continue;
+        }
+        if (fields != 3 || pad >= TOUCH_PAD_MAX || end_ms < start_ms) {
+            std::fprintf(stderr, "%s:%d: expected \"pad start_ms end_ms\"\n",
+                         path.c_str(), line_number);
+            ok = false;
+            break;
+        }
+        labels.push_back({static_cast<uint8_t>(pad), static_cast<uint32_t>(start_ms),
+                          static_cast<uint32_t>(end_ms)});
+    }
+    std::fclose(in);
+    return ok;
+}
+
+/** @brief Synthetic trace of four pads sampled every 10 ms */
+Trace synthesize(const unsigned seed, const uint32_t length_s)
+{
+    constexpr int num_pads = 4;
+    constexpr uint32_t period_ms = 10;
+    constexpr uint32_t edge_ms = 20;
+    enum Kind {TOUCH, HOVER, SPIKE};
+    struct Contact
+    {
+        uint32_t start_ms;
+        uint32_t end_ms;
+        double depth;
+    };
+
+    std::mt19937 rng(seed);
+    auto uniform = [&rng](const double lo, const double hi) {
+        return std::uniform_real_distribution<double>(lo, hi)(rng);
+    };
+    Trace trace;
+    trace.name = "synth" + std::to_string(seed);
+    const uint32_t length_ms = length_s * 1000;
+
+    std::vector<Contact> contacts[num_pads];
+    double idle[num_pads], drift_period_ms[num_pads], drift_phase[num_pads];
+    for (int i=0; i<num_pads; ++i) {
+        idle[i] = uniform(600, 1000);
+        drift_period_ms[i] = uniform(60e3, 300e3);
+        drift_phase[i] = uniform(0, 2 * M_PI);
+        uint32_t t_ms = static_cast<uint32_t>(uniform(500, 3000));
+        while (t_ms < length_ms - 3000) {
+            const double kind_draw = uniform(0, 1);
+            const Kind kind = kind_draw < 0.7 ? TOUCH : kind_draw < 0.9 ? HOVER : SPIKE;
+            Contact contact;
+            contact.start_ms = t_ms;
+            if (kind == TOUCH) {
+                // Log-uniform from a quick tap to a long press
+                contact.end_ms = t_ms + static_cast<uint32_t>(std::exp(uniform(std::log(30.0),
+                                                                               std::log(1500.0))));
+                contact.depth = uniform(0.15, 0.45);
+                trace.labels.push_back({static_cast<uint8_t>(i), contact.start_ms,
+                                        contact.end_ms});
+            } else if (kind == HOVER) {
+                contact.end_ms = t_ms + static_cast<uint32_t>(uniform(200, 2000));
+                contact.depth = uniform(0.03, 0.10);
+            } else {
+                contact.end_ms = t_ms;
+                contact.depth = uniform(0.20, 0.40);
+            }
+            contacts[i].push_back(contact);
+            t_ms = contact.end_ms + static_cast<uint32_t>(uniform(500, 3000));
+        }
+    }
+    std::sort(trace.labels.begin(), trace.labels.end(),
+              [](const Label &a, const Label &b) {return a.start_ms < b.start_ms;});
+
+    std::normal_distribution<double> noise(0, 1);
+    touch_sim::IirFilter filter[num_pads];
+    size_t next_contact[num_pads] = {};
+    for (uint32_t t_ms=0; t_ms<length_ms; t_ms+=period_ms) {
+        TraceReader::Frame frame = {};
+        frame.timestamp_ms = t_ms;
+        frame.pad_mask = (1u << num_pads) - 1;
+        for (int i=0; i<num_pads; ++i) {
+            const double level = idle[i] * (1 + 0.03 * std::sin(2 * M_PI * t_ms / drift_period_ms[i]
+                                                                 + drift_phase[i]));
+            double drop = 0;
+            std::vector<Contact> &pad_contacts = contacts[i];
+            size_t &n = next_contact[i];
+            while (n < pad_contacts.size() && pad_contacts[n].end_ms + edge_ms < t_ms) {
+                ++n;
+            }
+            if (n < pad_contacts.size() && pad_contacts[n].start_ms <= t_ms) {
+                const Contact &contact = pad_contacts[n];
+                if (contact.start_ms == contact.end_ms) {
+                    // Spike: a single sample
+                    drop = t_ms < contact.start_ms + period_ms ? contact.depth : 0;
+                } else {
+                    // Finger approach and lift take edge_ms each
+                    double ramp = std::min(1.0, (t_ms - contact.start_ms + 1.0) / edge_ms);
+                    if (t_ms > contact.end_ms) {
+                        ramp = std::max(0.0, 1 - static_cast<double>(t_ms - contact.end_ms)
+                                                 / edge_ms);
+                    }
+                    drop = contact.depth * ramp;
+                }
+            }
+            const double raw = level * (1 - drop) + 0.005 * idle[i] * noise(rng);
+            frame.raw_value[i] = static_cast<uint16_t>(std::max(0.0, std::min(65535.0, raw)));
+            if (!t_ms) {
+                filter[i].reset(frame.raw_value[i]);
+            }
+            frame.filtered_value[i] = filter[i].step(frame.raw_value[i]);
+        }
+        trace.frames.push_back(frame);
+    }
+    return trace;
+}
+
+class FilePrint : public Print
+{
+public:
+    explicit FilePrint(FILE *out) : out{out} {}
+    size_t write(uint8_t c) override {
+        return std::fputc(c, out) == EOF ? 0 : 1;
+    }
+    size_t write(const uint8_t *buffer, size_t size) override {
+        return std::fwrite(buffer, 1, size, out);
+    }
+    using Print::write;
+
+private:
+    FILE *out;
+};
+
+bool write_trace(const Trace &trace, const std::string &path)
+{
+    FILE *out = std::fopen(path.c_str(), "wb");
+    if (!out) {
+        std::perror(path.c_str());
+        return false;
+    }
+    FilePrint sink(out);
+    std::unique_ptr<TraceRecorder> recorder(new TraceRecorder);
+    recorder->start(trace.frames.front().pad_mask);
+    for (const TraceReader::Frame &frame : trace.frames) {
+        recorder->record(frame.raw_value, frame.filtered_value, frame.timestamp_ms);
+        recorder->drain(sink);
+    }
+    std::fclose(out);
+
+    const std::string labels_path = path + ".labels";
+    out = std::fopen(labels_path.c_str(), "w");
+    if (!out) {
+        std::perror(labels_path.c_str());
+        return false;
+    }
+    std::fprintf(out, "# pad start_ms end_ms\n");
+    for (const Label &label : trace.labels) {
+        std::fprintf(out, "%u %u %u\n", label.pad, label.start_ms, label.end_ms);
+    }
+    std::fclose(out);
+    return true;
+}
+
+Score evaluate(const Trace &trace, const touch_sim::ReplayConfig &config,
+               const uint32_t slack_ms)
+{
+    const touch_sim::ReplayResult result = touch_sim::replay(trace.frames, config);
+    std::vector<bool> matched(result.events.size(), false);
+    Score score;
+    for (const Label &label : trace.labels) {
+        ++score.touches;
+        for (size_t n=0; n<result.events.size(); ++n) {
+            const touch_sim::ReplayEvent &event = result.events[n];
+            if (matched[n] || event.pad != label.pad
+                    || event.state != ESP32Touch::SHORT_PRESSED
+                    || event.timestamp_ms < label.start_ms) {
+                continue;
+            }
+            if (event.timestamp_ms > label.end_ms + slack_ms) {
+                // Events are in time order
+                break;
+            }
+            matched[n] = true;
+            score.latencies_ms.push_back(event.timestamp_ms - label.start_ms);
+            break;
+        }
+    }
+    for (size_t n=0; n<result.events.size(); ++n) {
+        if (!matched[n] && result.events[n].state == ESP32Touch::SHORT_PRESSED) {
+            ++score.false_positives;
+        }
+    }
+    return score;
+}
+
+/** @brief Run tasks 0..num_tasks-1 on a work-stealing thread pool
+ * @return Number of tasks stolen from another thread's deque
+ */
+unsigned long run_work_stealing(const size_t num_tasks, const unsigned num_threads,
+                                const std::function<void(size_t)> &task)
+{
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+    std::vector<Queue> queues(num_threads);
+    // Contiguous blocks of task numbers per thread. With the caller's
+    // numbering (setting-major), a block covers a few settings, each
+    // over all traces.
+    for (size_t n=0; n<num_tasks; ++n) {
+        queues[n * num_threads / num_tasks].tasks.push_back(n);
+    }
+    std::atomic<unsigned long> steals{0};
+
+    auto worker = [&](const unsigned self) {
+        for (;;) {
+            size_t n;
+            bool found = false;
+            {
+                std::lock_guard<std::mutex> lock(queues[self].mutex);
+                if (!queues[self].tasks.empty()) {
+                    n = queues[self].tasks.back();
+                    queues[self].tasks.pop_back();
+                    found = true;
+                }
+            }
+            for (unsigned k=1; !found && k<num_threads; ++k) {
+                Queue &victim = queues[(self + k) % num_threads];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.tasks.empty()) {
+                    n = victim.tasks.front();
+                    victim.tasks.pop_front();
+                    found = true;
+                    steals.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            if (!found) {
+                // No task spawns new ones, so all deques are drained
+                return;
+            }
+            task(n);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned t=1; t<num_threads; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    return steals.load();
+}
+
+Summary summarize(const std::vector<Score> &scores, const double hours)
+{
+    Summary summary;
+    std::vector<uint32_t> latencies;
+    for (const Score &score : scores) {
+        summary.touches += score.touches;
+        summary.false_positives += score.false_positives;
+        latencies.insert(latencies.end(), score.latencies_ms.begin(),
+                         score.latencies_ms.end());
+    }
+    summary.detected = latencies.size();
+    summary.hours = hours;
+    summary.fn_rate = summary.touches ? 1 - static_cast<double>(summary.detected)
+                                            / summary.touches
+                                      : 0;
+    summary.fp_per_hour = hours > 0 ? summary.false_positives / hours : 0;
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        double sum = 0;
+        for (const uint32_t latency : latencies) {
+            sum += latency;
+        }
+        summary.latency_mean_ms = sum / latencies.size();
+        summary.latency_p50_ms = latencies[latencies.size() / 2];
+        summary.latency_p95_ms = latencies[std::min(latencies.size() - 1,
+                                                    latencies.size() * 95 / 100)];
+    }
+    return summary;
+}
+
+bool dominates(const Summary &a, const Summary &b)
+{
+    const bool no_worse = a.fn_rate <= b.fn_rate && a.fp_per_hour <= b.fp_per_hour
+                          && a.latency_mean_ms <= b.latency_mean_ms;
+    const bool better = a.fn_rate < b.fn_rate || a.fp_per_hour < b.fp_per_hour
+                        || a.latency_mean_ms < b.latency_mean_ms;
+    return no_worse && better;
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    std::vector<uint32_t> thresholds = {70, 75, 80, 85, 90};
+    std::vector<uint32_t> filter_periods = {10, 20, 40};
+    std::vector<uint32_t> dispatch_cycles = {10, 20, 50};
+    std::vector<uint32_t> short_press_times = {0, 20, 50, 100};
+    std::vector<uint32_t> debounce = {1, 2};
+    uint32_t slack_ms = 300;
+    unsigned num_threads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned num_synthetic = 0;
+    uint32_t synthetic_length_s = 120;
+    const char *write_prefix = nullptr;
+    bool pareto_only = false;
+    std::vector<std::string> paths;
+    for (int n=1; n<argc; ++n) {
+        const char *arg = argv[n];
+        const bool has_value = n + 1 < argc;
+        if (!std::strcmp(arg, "-t") && has_value) {
+            thresholds = parse_list(argv[++n]);
+        } else if (!std::strcmp(arg, "-p") && has_value) {
+            filter_periods = parse_list(argv[++n]);
+        } else if (!std::strcmp(arg, "-c") && has_value) {
+            dispatch_cycles = parse_list(argv[++n]);
+        } else if (!std::strcmp(arg, "-s") && has_value) {
+            short_press_times = parse_list(argv[++n]);
+        } else if (!std::strcmp(arg, "-d") && has_value) {
+            debounce = parse_list(argv[++n]);
+        } else if (!std::strcmp(arg, "-m") && has_value) {
+            slack_ms = std::atol(argv[++n]);
+        } else if (!std::strcmp(arg, "-j") && has_value) {
+            num_threads = std::atoi(argv[++n]);
+        } else if (!std::strcmp(arg, "-S") && has_value) {
+            num_synthetic = std::atoi(argv[++n]);
+        } else if (!std::strcmp(arg, "-L") && has_value) {
+            synthetic_length_s = std::atol(argv[++n]);
+        } else if (!std::strcmp(arg, "-W") && has_value) {
+            write_prefix = argv[++n];
+        } else if (!std::strcmp(arg, "-P")) {
+            pareto_only = true;
+        } else if (arg[0] != '-') {
+            paths.push_back(arg);
+        } else {
+            usage();
+        }
+    }
+    if (paths.empty() == !num_synthetic || num_threads < 1 || synthetic_length_s < 5) {
+        usage();
+    }
+    for (const uint32_t threshold : thresholds) {
+        if (threshold < 1 || threshold > 99) {
+            std::fprintf(stderr, "Thresholds must be 1..99 percent\n");
+            return 2;
+        }
+    }
+
+    touch_sim::set_serial_output(false);
+    std::vector<Trace> traces;
+    for (unsigned n=0; n<num_synthetic; ++n) {
+        traces.push_back(synthesize(n, synthetic_length_s));
+        if (write_prefix
+                && !write_trace(traces.back(), write_prefix + std::to_string(n) + ".bin")) {
+            return 1;
+        }
+    }
+    for (const std::string &path : paths) {
+        Trace trace;
+        trace.name = path;
+        std::vector<uint8_t> data;
+        if (!read_file(path, data) || !read_labels(path + ".labels", trace.labels)) {
+            return 1;
+        }
+        trace.frames = touch_sim::read_trace(data.data(), data.size());
+        if (trace.frames.size() < 2) {
+            std::fprintf(stderr, "%s: no frames\n", path.c_str());
+            return 1;
+        }
+        traces.push_back(std::move(trace));
+    }
+    // Replays can only decimate the recorded filter output, see refilter()
+    for (const Trace &trace : traces) {
+        const uint32_t recorded_ms = touch_sim::recorded_filter_period_ms(trace.frames);
+        for (const uint32_t filter_period : filter_periods) {
+            if (!recorded_ms || filter_period < recorded_ms || filter_period % recorded_ms) {
+                std::fprintf(stderr, "%s: filter period %u ms is not a multiple of the "
+                             "recorded %u ms\n", trace.name.c_str(), filter_period,
+                             recorded_ms);
+                return 2;
+            }
+        }
+    }
+    double hours = 0;
+    for (const Trace &trace : traces) {
+        hours += (trace.frames.back().timestamp_ms - trace.frames.front().timestamp_ms)
+                 / 3600e3;
+    }
+
+    std::vector<Setting> settings;
+    for (const uint32_t threshold : thresholds)
+    for (const uint32_t filter_period : filter_periods)
+    for (const uint32_t dispatch_cycle : dispatch_cycles)
+    for (const uint32_t short_press : short_press_times)
+    for (const uint32_t samples : debounce) {
+        Setting setting;
+        touch_sim::ReplayConfig &config = setting.config;
+        config.threshold_percent = static_cast<uint8_t>(threshold);
+        config.filter_period_ms = filter_period;
+        config.dispatch_cycle_time_ms = dispatch_cycle;
+        config.short_press_ms = short_press;
+        config.medium_press_ms = std::max(config.medium_press_ms, config.short_press_ms);
+        config.long_press_ms = std::max(config.long_press_ms, config.medium_press_ms);
+        config.press_debounce_samples = static_cast<uint8_t>(samples);
+        config.release_debounce_samples = static_cast<uint8_t>(samples);
+        setting.debounce_samples = static_cast<uint8_t>(samples);
+        settings.push_back(setting);
+    }
+
+    const size_t num_tasks = settings.size() * traces.size();
+    std::vector<Score> scores(num_tasks);
+    const auto t0 = std::chrono::steady_clock::now();
+    const unsigned long steals = run_work_stealing(num_tasks, num_threads, [&](size_t n) {
+        scores[n] = evaluate(traces[n % traces.size()], settings[n / traces.size()].config,
+                             slack_ms);
+    });
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                                         - t0).count();
+
+    std::vector<Summary> summaries;
+    for (size_t s=0; s<settings.size(); ++s) {
+        const auto first = scores.begin() + s * traces.size();
+        summaries.push_back(summarize(std::vector<Score>(first, first + traces.size()),
+                                      hours));
+    }
+    unsigned long num_pareto = 0;
+    for (Summary &candidate : summaries) {
+        candidate.pareto = std::none_of(summaries.begin(), summaries.end(),
+                                        [&candidate](const Summary &other) {
+                                            return dominates(other, candidate);
+                                        });
+        num_pareto += candidate.pareto;
+    }
+
+    std::printf("threshold_percent,filter_period_ms,dispatch_cycle_time_ms,short_press_ms,"
+                "debounce_samples,touches,detected,fn_rate,false_positives,fp_per_hour,"
+                "latency_mean_ms,latency_p50_ms,latency_p95_ms,pareto\n");
+    for (size_t s=0; s<settings.size(); ++s) {
+        const touch_sim::ReplayConfig &config = settings[s].config;
+        const Summary &summary = summaries[s];
+        if (pareto_only && !summary.pareto) {
+            continue;
+        }
+        std::printf("%u,%u,%u,%u,%u,%lu,%lu,%.4f,%lu,%.1f,%.1f,%u,%u,%d\n",
+                    config.threshold_percent, config.filter_period_ms,
+                    config.dispatch_cycle_time_ms, config.short_press_ms,
+                    settings[s].debounce_samples, summary.touches, summary.detected,
+                    summary.fn_rate, summary.false_positives, summary.fp_per_hour,
+                    summary.latency_mean_ms, summary.latency_p50_ms,
+                    summary.latency_p95_ms, summary.pareto ? 1 : 0);
+    }
+    std::fprintf(stderr, "%zu settings x %zu traces (%.2f h) on %u threads: "
+                         "%.2f s, %.0f replays/s, %lu steals, %lu Pareto-optimal\n",
+                 settings.size(), traces.size(), hours, num_threads, seconds,
+                 seconds > 0 ? num_tasks / seconds : 0, steals, num_pareto);
+    return 0;
+}
@@ -0,0 +1,72 @@
+/** @file touch_log_decode.cpp
+ * @brief Host tool: decode binary TouchLog records into text
+ *
+ * Reads the output of TouchLog::flush(out, true), e.g. a capture of the
+ * serial port, and prints one line of text per record. Bytes which do not
+ * form a valid record, e.g. when the capture starts in the middle of one,
+ * are skipped and counted.
+ *
+ * The message table is compiled in from src/touch_log_messages.h, so it
+ * must match the firmware which produced the log.
+ *
+ * Usage: touch_log_decode [file]   (reads stdin without a file)
+ */
+#include <cstdio>
+#include <vector>
+
+#include "touch_log.h"
+
+namespace
+{
+
+class StdoutPrint : public Print
+{
+public:
+    size_t write(uint8_t c) override {
+        return std::fputc(c, stdout) == EOF ? 0 : 1;
+    }
+    size_t write(const uint8_t *buffer, size_t size) override {
+        return std::fwrite(buffer, 1, size, stdout);
+    }
+    using Print::write;
+};
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    FILE *in = argc > 1 ? std::fopen(argv[1], "rb") : stdin;
+    if (!in) {
+        std::perror(argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+
+    StdoutPrint out;
+    unsigned long records = 0;
+    unsigned long skipped = 0;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        TouchLog::Record record;
+        const size_t used = TouchLog::decode(&data[pos], data.size() - pos, record);
+        if (used == 0) {
+            // Truncated record at the end of the capture
+            skipped += data.size() - pos;
+            break;
+        }
+        if (used == 1) {
+            ++skipped;
+        } else {
+            TouchLog::format(out, record);
+            ++records;
+        }
+        pos += used;
+    }
+    std::fprintf(stderr, "%lu records, %lu bytes skipped\n", records, skipped);
+    return 0;
+}
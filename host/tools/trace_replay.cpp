@@ -0,0 +1,114 @@
+/** @file trace_replay.cpp
+ * @brief Host tool: replay a recorded sensor trace through the detection
+ *        pipeline and print the resulting events
+ *
+ * Prints one line per user callback:
+ *
+ *     timestamp_ms pad state edge
+ *
+ * so that the output of two library versions or two settings can be
+ * compared with diff. The replay runs on the virtual clock of the trace,
+ * as fast as the CPU allows; throughput goes to stderr.
+ *
+ * Usage: trace_replay [options] trace.bin
+ *   -t percent   press threshold (default 80)
+ *   -r percent   release threshold, 0 for none (default 0)
+ *   -d samples   press and release debounce samples (default 1)
+ *   -b shift     baseline tracking shift, 0 to disable (default 12)
+ *   -f           trigger on release (FALL) instead of on press
+ *   -n count     replay count times, for throughput measurement
+ *   -q           do not print the events
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "touch_sim.h"
+#include "trace_replay.h"
+
+namespace
+{
+
+void usage()
+{
+    std::fprintf(stderr, "Usage: trace_replay [-t percent] [-r percent] [-d samples] "
+                         "[-b shift] [-f] [-n count] [-q] trace.bin\n");
+    std::exit(2);
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+    touch_sim::ReplayConfig config;
+    long repeat = 1;
+    bool quiet = false;
+    const char *path = nullptr;
+    for (int n=1; n<argc; ++n) {
+        const char *arg = argv[n];
+        const bool has_value = n + 1 < argc;
+        if (!std::strcmp(arg, "-t") && has_value) {
+            config.threshold_percent = std::atoi(argv[++n]);
+        } else if (!std::strcmp(arg, "-r") && has_value) {
+            config.release_threshold_percent = std::atoi(argv[++n]);
+        } else if (!std::strcmp(arg, "-d") && has_value) {
+            config.press_debounce_samples = std::atoi(argv[++n]);
+            config.release_debounce_samples = config.press_debounce_samples;
+        } else if (!std::strcmp(arg, "-b") && has_value) {
+            config.baseline_tracking_shift = std::atoi(argv[++n]);
+        } else if (!std::strcmp(arg, "-f")) {
+            config.edge = ESP32Touch::FALL;
+        } else if (!std::strcmp(arg, "-n") && has_value) {
+            repeat = std::atol(argv[++n]);
+        } else if (!std::strcmp(arg, "-q")) {
+            quiet = true;
+        } else if (arg[0] != '-' && !path) {
+            path = arg;
+        } else {
+            usage();
+        }
+    }
+    if (!path || repeat < 1) {
+        usage();
+    }
+    FILE *in = std::fopen(path, "rb");
+    if (!in) {
+        std::perror(path);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t size;
+    while ((size = std::fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        data.insert(data.end(), chunk, chunk + size);
+    }
+    std::fclose(in);
+
+    touch_sim::set_serial_output(false);
+    const std::vector<TraceReader::Frame> frames = touch_sim::read_trace(data.data(),
+                                                                          data.size());
+    touch_sim::ReplayResult result;
+    unsigned long frames_total = 0;
+    unsigned long events_total = 0;
+    double seconds = 0;
+    for (long n=0; n<repeat; ++n) {
+        result = touch_sim::replay(frames, config);
+        frames_total += result.frames;
+        events_total += result.events.size();
+        seconds += result.seconds;
+    }
+    if (!quiet) {
+        for (const touch_sim::ReplayEvent &event : result.events) {
+            std::printf("%u %u %s %s\n", event.timestamp_ms, event.pad,
+                        touch_sim::state_name(event.state),
+                        event.edge == ESP32Touch::RISE ? "RISE" : "FALL");
+        }
+    }
+    std::fprintf(stderr, "%zu frames, %zu events per replay; "
+                         "%.0f frames/s, %.0f events/s\n",
+                 frames.size(), result.events.size(),
+                 seconds > 0 ? frames_total / seconds : 0,
+                 seconds > 0 ? events_total / seconds : 0);
+    return 0;
+}
@@ -0,0 +1,65 @@
+/** @file trace_to_csv.cpp
+ * @brief Host tool: convert a TraceRecorder trace into CSV
+ *
+ * Reads a binary trace, e.g. a capture of the serial port or a file
+ * written by TraceRecorder::drain(), and prints one line per frame:
+ *
+ *     timestamp_ms,raw_<pad>,filtered_<pad>,...
+ *
+ * for the recorded pads. A new header line is printed whenever the set of
+ * recorded pads changes, and dropped frames are reported on stderr.
+ *
+ * Usage: trace_to_csv [file]   (reads stdin without a file)
+ */
+#include <cstdio>
+#include <vector>
+
+#include "trace_recorder.h"
+
+int main(int argc, char *argv[])
+{
+    FILE *in = argc > 1 ? std::fopen(argv[1], "rb") : stdin;
+    if (!in) {
+        std::perror(argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+
+    TraceReader reader(data.data(), data.size());
+    TraceReader::Frame frame;
+    unsigned long frames = 0;
+    unsigned long dropped = 0;
+    int pad_mask = -1;
+    while (reader.next(frame)) {
+        if (frame.dropped_before) {
+            std::fprintf(stderr, "%u frames dropped before %u ms\n",
+                         frame.dropped_before, frame.timestamp_ms);
+            dropped += frame.dropped_before;
+        }
+        if (frame.pad_mask != pad_mask) {
+            pad_mask = frame.pad_mask;
+            std::printf("timestamp_ms");
+            for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+                if (pad_mask & (1 << i)) {
+                    std::printf(",raw_%d,filtered_%d", i, i);
+                }
+            }
+            std::printf("\n");
+        }
+        std::printf("%u", frame.timestamp_ms);
+        for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+            if (pad_mask & (1 << i)) {
+                std::printf(",%u,%u", frame.raw_value[i], frame.filtered_value[i]);
+            }
+        }
+        std::printf("\n");
+        ++frames;
+    }
+    std::fprintf(stderr, "%lu frames, %lu dropped\n", frames, dropped);
+    return 0;
+}
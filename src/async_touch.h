@@ -0,0 +1,269 @@
+/** @file async_touch.h
+ * @brief C++20 coroutine interface for ESP32Touch
+ *
+ * Header only and optional: the library itself stays C++11, this header
+ * needs a C++20 compiler with coroutine support (e.g. -std=gnu++20).
+ */
+#ifndef ASYNC_TOUCH_H
+#define ASYNC_TOUCH_H
+
+#if !defined(__cpp_impl_coroutine)
+#error "async_touch.h needs C++20 coroutines, e.g. -std=gnu++20"
+#endif
+
+#include <stdint.h>
+#include <coroutine>
+#include <exception>
+
+#include <Arduino.h>
+
+#include "esp32_touch.h"
+
+/** @brief Maximum number of coroutines waiting on one AsyncTouch at once */
+#ifndef ESP32TOUCH_MAX_AWAITERS
+#define ESP32TOUCH_MAX_AWAITERS 8
+#endif
+
+/************************** AsyncTouch ***************************************//**
+ * @brief Awaitable touch events for sequential input flows
+ *
+ * Instead of chaining callbacks, a coroutine waits for one event after
+ * the other:
+ *
+ *     TouchTask unlock(AsyncTouch &touch) {
+ *         for (;;) {
+ *             co_await touch.nextPress(4);
+ *             auto result = co_await touch.anyPress(1u << 5 | 1u << 6, 2000);
+ *             if (result && result.event.pad == 6) {
+ *                 open_door();
+ *             }
+ *         }
+ *     }
+ *
+ * Pads and states are registered with AsyncTouch::configure_input(), which
+ * installs a TouchEvent callback (ESP32Touch::configure_input()) for them.
+ * Waiting coroutines are resumed from that callback, i.e. they run in the
+ * event loop context like any other callback and must not block.
+ * An event resumes every coroutine waiting for it; events nobody waits
+ * for are dropped.
+ *
+ * Each co_await expression stores its awaiter in the coroutine frame and
+ * links it into a fixed table of ESP32TOUCH_MAX_AWAITERS slots, so waiting
+ * never allocates. With the table full, co_await returns BUSY at once.
+ * Only the coroutine frame itself is allocated, once per coroutine call.
+ *
+ * Not thread-safe: start coroutines from the event loop context, or
+ * before the event loop runs (before begin() or in detached mode).
+ * A coroutine may not be destroyed while it waits.
+ */
+class AsyncTouch
+{
+public:
+    enum Status : uint8_t {
+        PRESSED,
+        /** @brief anyPress() timeout expired */
+        TIMED_OUT,
+        /** @brief No free awaiter slot */
+        BUSY,
+    };
+
+    /** @brief Value of a co_await expression */
+    struct Result
+    {
+        Status status;
+        /** @brief The event, valid for PRESSED */
+        ESP32Touch::TouchEvent event;
+
+        explicit operator bool() const noexcept {
+            return status == PRESSED;
+        }
+    };
+
+    /** @brief Awaiter returned by nextPress() and anyPress() */
+    class Awaiter
+    {
+    public:
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) noexcept {
+            this->handle = handle;
+            deadline_ms = millis() + timeout_ms;
+            if (!owner.link(this)) {
+                result.status = BUSY;
+                return false;
+            }
+            return true;
+        }
+
+        Result await_resume() const noexcept {
+            return result;
+        }
+
+    private:
+        friend class AsyncTouch;
+
+        Awaiter(AsyncTouch &owner, const uint16_t pad_mask, const int state,
+                const uint32_t timeout_ms)
+            : owner{owner}
+            , pad_mask{pad_mask}
+            , state{state}
+            , timeout_ms{timeout_ms}
+        {}
+
+        bool matches(const ESP32Touch::TouchEvent &event) const {
+            return (pad_mask & (1u << event.pad)) && (state < 0 || state == event.state);
+        }
+
+        AsyncTouch &owner;
+        uint16_t pad_mask;
+        // BUTTON_STATE to wait for, -1 for any
+        int state;
+        // 0 waits forever
+        uint32_t timeout_ms;
+        uint32_t deadline_ms = 0;
+        std::coroutine_handle<> handle;
+        Result result{TIMED_OUT, {}};
+    };
+
+    /** @brief Resumes timed out anyPress() waiters from the event loop
+     *         via ESP32Touch::setCycleCallback(), which it takes over.
+     *         Construct it before ESP32Touch::startDispatcherTask() and
+     *         destroy it after ESP32Touch::stopDispatcherTask().
+     */
+    explicit AsyncTouch(ESP32Touch &touch)
+        : touch{touch}
+    {
+        touch.setCycleCallback([this](uint32_t timestamp_ms) {
+            expire(timestamp_ms);
+        });
+    }
+
+    ~AsyncTouch() {
+        touch.setCycleCallback(nullptr);
+    }
+
+    AsyncTouch(const AsyncTouch &) = delete;
+    AsyncTouch &operator=(const AsyncTouch &) = delete;
+
+    /** @brief Deliver the events of a pad and state to waiting coroutines.
+     *         Arguments as for ESP32Touch::configure_input(), which this
+     *         replaces for that pad and state.
+     */
+    void configure_input(const int input_number,
+                         const uint8_t threshold_percent,
+                         const ESP32Touch::BUTTON_STATE buttonState = ESP32Touch::SHORT_PRESSED,
+                         const ESP32Touch::TRIGGER_MODE edgeTrigger = ESP32Touch::RISE,
+                         const bool waitForRelease = true,
+                         const uint8_t release_threshold_percent = 0) {
+        touch.configure_input(input_number, threshold_percent,
+                              [this](const ESP32Touch::TouchEvent &event) {
+                                  deliver(event);
+                              },
+                              buttonState, edgeTrigger, waitForRelease,
+                              release_threshold_percent);
+    }
+
+    /** @brief co_await the next event of one pad and state, without timeout */
+    Awaiter nextPress(const int input_number,
+                      const ESP32Touch::BUTTON_STATE buttonState = ESP32Touch::SHORT_PRESSED) {
+        return Awaiter{*this, static_cast<uint16_t>(1u << input_number), buttonState, 0};
+    }
+
+    /** @brief co_await the next event of any pad in pad_mask, in any of
+     *         its configured states
+     * @param pad_mask Bit n set for touch pad n
+     * @param timeout_ms Resume with TIMED_OUT after this time, 0 for none.
+     *                   Checked once per event loop cycle, also while
+     *                   idle in interrupt driven mode (see
+     *                   ESP32Touch::setCycleCallback()).
+     */
+    Awaiter anyPress(const uint16_t pad_mask, const uint32_t timeout_ms = 0) {
+        return Awaiter{*this, pad_mask, -1, timeout_ms};
+    }
+
+    /** @brief Number of coroutines currently waiting */
+    int waiting() const {
+        int n = 0;
+        for (const Awaiter *awaiter : awaiters) {
+            n += awaiter != nullptr;
+        }
+        return n;
+    }
+
+private:
+    ESP32Touch &touch;
+    Awaiter *awaiters[ESP32TOUCH_MAX_AWAITERS] = {};
+
+    bool link(Awaiter *awaiter) {
+        for (Awaiter *&slot : awaiters) {
+            if (!slot) {
+                slot = awaiter;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Unlink all awaiters for which done() holds first, then resume them.
+    // A resumed coroutine can thus co_await again right away without its
+    // new awaiter seeing the same event.
+    template<typename Predicate>
+    void resume_if(Predicate done) {
+        Awaiter *ready[ESP32TOUCH_MAX_AWAITERS];
+        int num_ready = 0;
+        for (Awaiter *&slot : awaiters) {
+            if (slot && done(*slot)) {
+                ready[num_ready++] = slot;
+                slot = nullptr;
+            }
+        }
+        for (int n=0; n<num_ready; ++n) {
+            ready[n]->handle.resume();
+        }
+    }
+
+    void deliver(const ESP32Touch::TouchEvent &event) {
+        resume_if([&event](Awaiter &awaiter) {
+            if (!awaiter.matches(event)) {
+                return false;
+            }
+            awaiter.result = Result{PRESSED, event};
+            return true;
+        });
+    }
+
+    void expire(const uint32_t timestamp_ms) {
+        resume_if([timestamp_ms](Awaiter &awaiter) {
+            // Wrap-around safe "deadline reached" comparison
+            return awaiter.timeout_ms
+                   && static_cast<int32_t>(timestamp_ms - awaiter.deadline_ms) >= 0;
+        });
+    }
+};
+
+/** @brief Minimal fire-and-forget coroutine type for AsyncTouch flows.
+ *         Starts running at once and frees its frame when it returns.
+ */
+struct TouchTask
+{
+    struct promise_type
+    {
+        TouchTask get_return_object() noexcept {
+            return {};
+        }
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+    };
+};
+
+#endif
@@ -0,0 +1,58 @@
+/** @file baseline_tracker.h */
+#ifndef BASELINE_TRACKER_H
+#define BASELINE_TRACKER_H
+
+#include <stdint.h>
+
+/************************ BaselineTracker ************************************//**
+ * @brief Integer-only slow EWMA of the idle-state touch sensor readout
+ * 
+ * Tracks the readout of an untouched pad in Q16 fixed point, following
+ * slow drift caused by temperature or humidity. Each update moves the
+ * baseline by 1 / 2^shift of the difference to the new value, i.e. the
+ * time constant is 2^shift samples. No multiplications, no floating point.
+ * 
+ * The caller is responsible for not feeding samples taken while the pad
+ * is touched (freezing the baseline during a press).
+ */
+class BaselineTracker
+{
+public:
+    /** @brief Longest supported time constant, see update() */
+    static constexpr uint8_t MAX_SHIFT = 16;
+
+    /** @brief Restart tracking from the given value, e.g. after calibration */
+    void reset(const uint16_t value) {
+        state = static_cast<uint32_t>(value) << frac_bits;
+    }
+
+    /** @brief Feed one idle-state sample
+     * @param value Filtered sensor readout
+     * @param shift Time constant as a power of two number of samples
+     *              (1..MAX_SHIFT)
+     * @return true if the integer part of the baseline changed
+     */
+    bool update(const uint16_t value, const uint8_t shift) {
+        const uint16_t before = baseline();
+        const uint32_t target = static_cast<uint32_t>(value) << frac_bits;
+        // Unsigned in both directions to avoid any overflow
+        if (target > state) {
+            state += (target - state) >> shift;
+        } else {
+            state -= (state - target) >> shift;
+        }
+        return baseline() != before;
+    }
+
+    /** @brief Current baseline, rounded to the nearest sensor count */
+    uint16_t baseline() const {
+        const uint32_t rounded = state + (1u << (frac_bits - 1));
+        return rounded < state ? UINT16_MAX : rounded >> frac_bits;
+    }
+
+private:
+    static constexpr int frac_bits = 16;
+    uint32_t state = 0;
+};
+
+#endif
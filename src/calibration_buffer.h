@@ -0,0 +1,121 @@
+/** @file calibration_buffer.h */
+#ifndef CALIBRATION_BUFFER_H
+#define CALIBRATION_BUFFER_H
+
+#include <stdint.h>
+
+/************************ CalibrationBuffer **********************************//**
+ * @brief Fixed-size sample buffer with outlier-rejecting mean and noise
+ *
+ * Collects up to MaxSamples filtered sensor readouts of one touch pad.
+ * evaluate() then rejects outliers, i.e. samples deviating from the median
+ * by more than five median absolute deviations (about 3.4 sigma for
+ * gaussian noise), and reports mean and standard deviation of the rest.
+ *
+ * Integer-only, no heap allocation. evaluate() sorts in O(n^2), which is
+ * intended for the small sample counts used for calibration.
+ */
+template <int MaxSamples>
+class CalibrationBuffer
+{
+    static_assert(MaxSamples > 0 && MaxSamples <= 255,
+                  "MaxSamples must be in the range 1..255");
+public:
+    void clear() {
+        count = 0;
+    }
+
+    /** @brief Append one sample. Samples beyond MaxSamples are ignored. */
+    void add(const uint16_t value) {
+        if (count < MaxSamples) {
+            samples[count++] = value;
+        }
+    }
+
+    int size() const {
+        return count;
+    }
+
+    /** @brief Evaluate the collected samples. This reorders the buffer.
+     * @param mean Mean value of the samples which are not outliers
+     * @param noise Standard deviation of the samples which are not outliers
+     * @return false if there are no samples or more than half of them
+     *         were rejected as outliers; mean and noise are then unchanged.
+     */
+    bool evaluate(uint16_t &mean, uint16_t &noise) {
+        if (count == 0) {
+            return false;
+        }
+        sort(samples, count);
+        const uint16_t median = samples[count / 2];
+        uint16_t deviation[MaxSamples];
+        for (int i=0; i<count; ++i) {
+            deviation[i] = distance(samples[i], median);
+        }
+        sort(deviation, count);
+        // +2 tolerates quantization when (almost) all samples are equal
+        const uint32_t limit = 5u * deviation[count / 2] + 2;
+
+        uint32_t sum = 0;
+        int retained = 0;
+        for (int i=0; i<count; ++i) {
+            if (distance(samples[i], median) <= limit) {
+                sum += samples[i];
+                ++retained;
+            }
+        }
+        if (2 * retained < count) {
+            return false;
+        }
+        const uint16_t new_mean = (sum + retained / 2) / retained;
+        uint64_t sum_sq = 0;
+        for (int i=0; i<count; ++i) {
+            if (distance(samples[i], median) <= limit) {
+                const uint64_t d = distance(samples[i], new_mean);
+                sum_sq += d * d;
+            }
+        }
+        mean = new_mean;
+        noise = isqrt(static_cast<uint32_t>(sum_sq / retained));
+        return true;
+    }
+
+private:
+    uint16_t samples[MaxSamples];
+    uint8_t count = 0;
+
+    static uint16_t distance(const uint16_t a, const uint16_t b) {
+        return a > b ? a - b : b - a;
+    }
+
+    static void sort(uint16_t *values, const int n) {
+        for (int i=1; i<n; ++i) {
+            const uint16_t v = values[i];
+            int j = i;
+            for (; j>0 && values[j-1] > v; --j) {
+                values[j] = values[j-1];
+            }
+            values[j] = v;
+        }
+    }
+
+    static uint16_t isqrt(uint32_t x) {
+        uint32_t root = 0;
+        uint32_t bit = 1ul << 30;
+        while (bit > x) {
+            bit >>= 2;
+        }
+        while (bit) {
+            if (x >= root + bit) {
+                x -= root + bit;
+                root = (root >> 1) + bit;
+            } else {
+                root >>= 1;
+            }
+            bit >>= 2;
+        }
+        return root;
+    }
+};
+
+#endif
@@ -1,9 +1,6 @@
 //#include "esp_log.h"
 //#include "esp32-hal-log.h"
 
-//#include "freertos/FreeRTOS.h"
-//#include "freertos/task.h"
-
 //#include "soc/rtc_cntl_reg.h"
 //#include "soc/sens_reg.h"
 
@@ -14,6 +11,8 @@
 ESP32Touch::ESP32Touch()
     : event_timer{[this](){this->dispatch_callbacks();}, dispatch_cycle_time_ms, 0, MILLIS}
 {   
+    event_semaphore = xSemaphoreCreateBinaryStatic(&event_semaphore_buffer);
+    dispatcher_task_done = xSemaphoreCreateBinaryStatic(&dispatcher_task_done_buffer);
     // Initialize touch pad peripheral, it will start a timer to run a filter
     touch_pad_init();
     // If use interrupt trigger mode, should set touch sensor FSM mode at 'TOUCH_FSM_MODE_TIMER'.
@@ -28,8 +27,23 @@ ESP32Touch::ESP32Touch()
 
 ESP32Touch::~ESP32Touch()
 {
+    stopDispatcherTask();
     disableEventTimer();
-    delete &event_timer;
+    disableTouchInterrupt();
+    if (unregisterInstance()) {
+        // Let a filter callback or ISR still using this instance finish
+        while (s_instance_users.load()) {
+            vTaskDelay(1);
+        }
+    }
+    // The callback slots do not know their member, see StateCallback
+    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+        for (int s=0; s<NUM_STATES_DONT_USE; ++s) {
+            clearCallback(i, static_cast<BUTTON_STATE>(s));
+        }
+    }
+    vSemaphoreDelete(dispatcher_task_done);
+    vSemaphoreDelete(event_semaphore);
 }
 
 void ESP32Touch::disableEventTimer()
@@ -39,23 +53,157 @@ void ESP32Touch::disableEventTimer()
 
 void ESP32Touch::enableEventTimer()
 {
+    // Samples queued while the timer was stopped are stale
+    sample_ring.clear();
     event_timer.start();
 }
 
 void ESP32Touch::updateButtons()
 {
+    if (dispatcher_task_stopped.load(std::memory_order_relaxed)) {
+        // Stopped from its own callback, see stopDispatcherTask()
+        reapDispatcherTask(0);
+    }
+    // Picks up period changes from setDispatchCycleTime() and adaptive dispatch
+    event_timer.interval(cycle_ms.load(std::memory_order_relaxed));
     event_timer.update();
 }
 
+bool ESP32Touch::startDispatcherTask(const UBaseType_t priority,
+                                     const uint32_t stack_size,
+                                     const BaseType_t core_id)
+{
+    if (dispatcher_task_handle.load()) {
+        return true;
+    }
+    if (!reapDispatcherTask(0)) {
+        // Stopped from its own callback and not yet finished
+        return false;
+    }
+    disableEventTimer();
+    dispatcher_task_running = true;
+    TaskHandle_t task = nullptr;
+    const BaseType_t result = xTaskCreatePinnedToCore(
+            dispatcher_task, "ESP32Touch", stack_size, this,
+            priority, &task, core_id);
+    if (result != pdPASS) {
+        touch_log(DISPATCHER_TASK_FAILED);
+        dispatcher_task_running = false;
+        enableEventTimer();
+        return false;
+    }
+    dispatcher_task_handle = task;
+    return true;
+}
+
+void ESP32Touch::stopDispatcherTask()
+{
+    TaskHandle_t task = dispatcher_task_handle.exchange(nullptr);
+    if (!task) {
+        // Possibly stopped from a callback before, unless this is that
+        // callback again
+        if (xTaskGetCurrentTaskHandle() != dispatcher_task_stopped.load()) {
+            reapDispatcherTask(portMAX_DELAY);
+        }
+        return;
+    }
+    dispatcher_task_running = false;
+    dispatcher_task_stopped = task;
+    if (xTaskGetCurrentTaskHandle() == task) {
+        // Called from a callback, i.e. by the task itself, which cannot
+        // wait for its own exit. updateButtons() deletes it later.
+        return;
+    }
+    // Wake the task in case it sleeps waiting for the touch ISR. It does
+    // not delete itself, so the handle stays valid.
+    xTaskNotifyGive(task);
+    reapDispatcherTask(portMAX_DELAY);
+}
+
+bool ESP32Touch::reapDispatcherTask(const TickType_t wait)
+{
+    TaskHandle_t task = dispatcher_task_stopped.load();
+    if (!task) {
+        return true;
+    }
+    if (xSemaphoreTake(dispatcher_task_done, wait) != pdTRUE) {
+        return false;
+    }
+    // A filter callback or ISR may still hold the handle loaded before
+    // stopDispatcherTask() cleared it, and notify the task with it
+    while (s_instance_users.load()) {
+        vTaskDelay(1);
+    }
+    vTaskDelete(task);
+    dispatcher_task_stopped = nullptr;
+    enableEventTimer();
+    return true;
+}
+
+void ESP32Touch::setDispatchCycleTime(const uint32_t cycle_ms)
+{
+    dispatch_cycle_time_ms = cycle_ms ? cycle_ms : 1;
+    active_cycle_ms.store(0, std::memory_order_relaxed);
+    this->cycle_ms.store(dispatch_cycle_time_ms, std::memory_order_relaxed);
+}
+
+void ESP32Touch::setAdaptiveDispatch(const uint32_t idle_cycle_ms,
+                                     const uint32_t active_cycle_ms,
+                                     const uint8_t approach_percent)
+{
+    this->approach_percent = approach_percent < 100 ? approach_percent : 100;
+    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+        if (tracked_mask & (1u << i)) {
+            updateThreshold(i);
+        }
+    }
+    const uint32_t active_ms = active_cycle_ms ? active_cycle_ms : 1;
+    this->idle_cycle_ms.store(idle_cycle_ms > active_ms ? idle_cycle_ms : active_ms,
+                              std::memory_order_relaxed);
+    // Start fast, the dispatcher slows down once it sees all pads idle
+    cycle_ms.store(active_ms, std::memory_order_relaxed);
+    this->active_cycle_ms.store(active_ms, std::memory_order_relaxed);
+}
+
+uint32_t ESP32Touch::getDispatchCycleTime()
+{
+    return cycle_ms.load(std::memory_order_relaxed);
+}
+
+void ESP32Touch::setCycleCallback(CycleCallbackT callback)
+{
+    cycle_callback = callback;
+}
+
 void ESP32Touch::initializeButton(const int input_number)
 {
-    s_pad_enabled[input_number] = false;
-    s_pad_threshold[input_number] = threshold_inactive;
+    const uint16_t pad_bit = 1u << input_number;
+    enabled_mask &= ~pad_bit;
+    rearm_mask &= ~pad_bit;
+    tracked_mask &= ~pad_bit;
+    pad_sense[input_number].threshold = threshold_inactive;
+    pad_sense[input_number].release_threshold = threshold_inactive;
+    pad_sense[input_number].approach_threshold = threshold_inactive;
+    pad_sense[input_number].debounce_count = 0;
+    debouncing_mask &= ~pad_bit;
+    for(int i=0;i<NUM_STATES_DONT_USE;++i)
+    {
+        active_mask[i] &= ~pad_bit;
+        clearCallback(input_number, static_cast<BUTTON_STATE>(i));
+        queued_mask[i] &= ~pad_bit;
+    }
+    pad_press[input_number].state = BUTTON_STATE::NO_PRESS;
+    pressed_mask &= ~pad_bit;
+    pad_press[input_number].next_state = NUM_STATES_DONT_USE;
     for(int i=0;i<NUM_STATES_DONT_USE;++i)
     {
-        s_pad_callback[input_number][i] = {};
+        pad_config[input_number].press_time_ms[i] = DEFAULT_PRESS_TIMES_MS[i];
     }
-    s_pad_state[input_number] = BUTTON_STATE::NO_PRESS;
+    pad_config[input_number].tap_window_ms = DEFAULT_MULTI_TAP_WINDOW_MS;
+    pad_config[input_number].chord_skew_ms = 0;
+    disableMultiTap(input_number);
+    repeat_mask &= ~pad_bit;
+    pad_config[input_number].repeat_callback = nullptr;
 }
 
 void ESP32Touch::initializeButtons()
@@ -67,19 +215,42 @@ void ESP32Touch::initializeButtons()
 
 void ESP32Touch::disableButton(const int input_number)
 {
-    s_pad_enabled[input_number] = false;
+    const uint16_t pad_bit = 1u << input_number;
+    enabled_mask &= ~pad_bit;
+    rearm_mask &= ~pad_bit;
+    tracked_mask &= ~pad_bit;
     for(int i=0;i<NUM_STATES_DONT_USE;++i)
     {
-        s_pad_active[input_number][i] = false;
-        s_pad_callback[input_number][i] = {};
+        active_mask[i] &= ~pad_bit;
+        clearCallback(input_number, static_cast<BUTTON_STATE>(i));
+        queued_mask[i] &= ~pad_bit;
     }
-    s_pad_state[input_number] = BUTTON_STATE::NO_PRESS;
+    pad_press[input_number].state = BUTTON_STATE::NO_PRESS;
+    pressed_mask &= ~pad_bit;
+    disableMultiTap(input_number);
+    repeat_mask &= ~pad_bit;
+    pad_config[input_number].repeat_callback = nullptr;
+}
 
+void ESP32Touch::disableMultiTap(const int input_number)
+{
+    const uint16_t pad_bit = 1u << input_number;
+    multi_tap_mask &= ~pad_bit;
+    tap_suppress_mask &= ~pad_bit;
+    tap_pending_mask &= ~pad_bit;
+    pad_press[input_number].tap_count = 0;
+    pad_config[input_number].max_taps = 0;
+    for(int i=0;i<MAX_TAP_COUNT-1;++i)
+    {
+        pad_config[input_number].tap_callback[i] = {};
+    }
 }
 
 void ESP32Touch::disableAllButtons()
 {
     disableEventTimer();
+    clearChords();
+    clearSliders();
     for (int i=0; i<TOUCH_PAD_MAX; ++i) {
         disableButton(i);
     }
@@ -90,127 +261,892 @@ void ESP32Touch::configure_input(const int input_number,
                                  CallbackT callback,
                                  const BUTTON_STATE buttonState,
                                  const TRIGGER_MODE edgeTrigger,
-                                 const bool waitForRelease)
+                                 const bool waitForRelease,
+                                 const uint8_t release_threshold_percent)
+{
+    touch_log(REGISTER_CALLBACK, input_number);
+    const uint16_t pad_bit = 1u << input_number;
+    enabled_mask |= pad_bit;
+    if (waitForRelease) {
+        // Becomes active with the first sample in which the pad is released
+        active_mask[buttonState] &= ~pad_bit;
+        rearm_mask |= pad_bit;
+    } else {
+        active_mask[buttonState] |= pad_bit;
+    }
+    pad_config[input_number].threshold_percent = threshold_percent;
+    pad_config[input_number].release_percent = release_threshold_percent > threshold_percent
+                                          ? release_threshold_percent : threshold_percent;
+    setCallback(input_number, buttonState, callback);
+    queued_mask[buttonState] &= ~pad_bit;
+    pad_press[input_number].state = BUTTON_STATE::NO_PRESS;
+    pad_press[input_number].trigger_mode = edgeTrigger;
+}
+
+void ESP32Touch::configure_input(const int input_number,
+                                 const uint8_t threshold_percent,
+                                 EventCallbackT callback,
+                                 const BUTTON_STATE buttonState,
+                                 const TRIGGER_MODE edgeTrigger,
+                                 const bool waitForRelease,
+                                 const uint8_t release_threshold_percent)
+{
+    configure_input(input_number, threshold_percent, CallbackT{}, buttonState,
+                    edgeTrigger, waitForRelease, release_threshold_percent);
+    setCallback(input_number, buttonState, callback);
+}
+
+void ESP32Touch::configure_queued_input(const int input_number,
+                                        const uint8_t threshold_percent,
+                                        const BUTTON_STATE buttonState,
+                                        const TRIGGER_MODE edgeTrigger,
+                                        const bool waitForRelease,
+                                        const uint8_t release_threshold_percent)
+{
+    configure_input(input_number, threshold_percent, CallbackT{}, buttonState,
+                    edgeTrigger, waitForRelease, release_threshold_percent);
+    queued_mask[buttonState] |= 1u << input_number;
+}
+
+bool ESP32Touch::pollEvent(TouchEvent &event)
+{
+    return event_queue.pop(event);
+}
+
+bool ESP32Touch::waitEvent(TouchEvent &event, const uint32_t timeout_ms)
+{
+    const TickType_t start = xTaskGetTickCount();
+    const TickType_t timeout = timeout_ms == UINT32_MAX ? portMAX_DELAY
+                                                        : pdMS_TO_TICKS(timeout_ms);
+    // The semaphore may be left given by an event which was polled
+    // already, so this can wake up to an empty queue
+    while (!event_queue.pop(event)) {
+        TickType_t wait = portMAX_DELAY;
+        if (timeout != portMAX_DELAY) {
+            const TickType_t elapsed = xTaskGetTickCount() - start;
+            if (elapsed >= timeout) {
+                return false;
+            }
+            wait = timeout - elapsed;
+        }
+        xSemaphoreTake(event_semaphore, wait);
+    }
+    return true;
+}
+
+uint32_t ESP32Touch::getEventQueueDropCount()
+{
+    return event_queue.overruns();
+}
+
+uint32_t ESP32Touch::getEventQueueHighWater()
+{
+    return event_queue_high_water.load(std::memory_order_relaxed);
+}
+
+void ESP32Touch::setPressDurations(const int input_number,
+                                   const uint32_t short_ms,
+                                   const uint32_t medium_ms,
+                                   const uint32_t long_ms)
+{
+    pad_config[input_number].press_time_ms[SHORT_PRESSED] = short_ms;
+    pad_config[input_number].press_time_ms[MEDIUM_PRESSED] = medium_ms;
+    pad_config[input_number].press_time_ms[LONG_PRESSED] = long_ms;
+}
+
+void ESP32Touch::configure_multi_tap(const int input_number,
+                                     const uint8_t num_taps,
+                                     CallbackT callback,
+                                     const bool suppress_single_tap)
 {
-    debug_print_sv("Registering callback for touch button no.: ", input_number);
-    //debug_print_hex("Callback address: ", (uint32_t)debug_get_address(&callback));
-    s_pad_enabled[input_number] = true;
-    s_pad_active[input_number][buttonState] = !(waitForRelease);
-    // debug_print_sv("Input active: ", s_pad_active[input_number]);
-    s_pad_threshold_percent[input_number] = threshold_percent;
-    s_pad_callback[input_number][buttonState] = callback;
-    s_pad_state[input_number] = BUTTON_STATE::NO_PRESS;
-    s_pad_trigger_mode[input_number] = edgeTrigger;
+    if (num_taps < 2 || num_taps > MAX_TAP_COUNT) {
+        touch_log(UNSUPPORTED_TAP_COUNT, num_taps);
+        return;
+    }
+    const uint16_t pad_bit = 1u << input_number;
+    PadConfig &config = pad_config[input_number];
+    config.tap_callback[num_taps - 2] = callback;
+    config.max_taps = 0;
+    for (int n=2; n<=MAX_TAP_COUNT; ++n) {
+        if (config.tap_callback[n - 2]) {
+            config.max_taps = n;
+        }
+    }
+    if (config.max_taps) {
+        multi_tap_mask |= pad_bit;
+    } else {
+        multi_tap_mask &= ~pad_bit;
+    }
+    if (suppress_single_tap && config.max_taps) {
+        tap_suppress_mask |= pad_bit;
+    } else {
+        tap_suppress_mask &= ~pad_bit;
+    }
+}
+
+void ESP32Touch::setMultiTapWindow(const int input_number, const uint16_t window_ms)
+{
+    pad_config[input_number].tap_window_ms = window_ms;
+}
+
+void ESP32Touch::configure_auto_repeat(const int input_number,
+                                       RepeatCallbackT callback,
+                                       const uint16_t delay_ms,
+                                       const uint16_t interval_ms,
+                                       const uint16_t min_interval_ms,
+                                       const uint8_t acceleration_percent)
+{
+    const uint16_t pad_bit = 1u << input_number;
+    PadConfig &config = pad_config[input_number];
+    config.repeat_delay_ms = delay_ms;
+    config.repeat_interval_ms = interval_ms;
+    config.repeat_min_interval_ms = min_interval_ms < interval_ms ? min_interval_ms
+                                                                  : interval_ms;
+    config.repeat_acceleration_percent = acceleration_percent < 100 ? acceleration_percent
+                                                                    : 99;
+    config.repeat_callback = callback;
+    if (callback) {
+        repeat_mask |= pad_bit;
+    } else {
+        repeat_mask &= ~pad_bit;
+    }
+}
+
+bool ESP32Touch::configure_chord(const uint16_t pad_mask,
+                                 CallbackT callback,
+                                 const uint16_t skew_ms)
+{
+    if (num_chords >= ESP32TOUCH_MAX_CHORDS || __builtin_popcount(pad_mask) < 2) {
+        touch_log(CHORD_NOT_REGISTERED, pad_mask);
+        return false;
+    }
+    Chord &chord = chords[num_chords];
+    chord.pad_mask = pad_mask;
+    chord.skew_ms = skew_ms;
+    chord.callback = callback;
+    ++num_chords;
+    uint16_t pads = pad_mask;
+    while (pads) {
+        const int i = __builtin_ctz(pads);
+        pads &= pads - 1;
+        if (skew_ms > pad_config[i].chord_skew_ms) {
+            pad_config[i].chord_skew_ms = skew_ms;
+        }
+    }
+    return true;
+}
+
+void ESP32Touch::clearChords()
+{
+    num_chords = 0;
+    chord_latched_mask = 0;
+    for (int n=0; n<ESP32TOUCH_MAX_CHORDS; ++n) {
+        chords[n].callback = nullptr;
+    }
+    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+        pad_config[i].chord_skew_ms = 0;
+    }
+}
+
+bool ESP32Touch::configure_slider(const uint8_t *pads,
+                                  const uint8_t num_pads,
+                                  SliderCallbackT callback,
+                                  const bool wheel,
+                                  const uint8_t threshold_percent)
+{
+    if (num_sliders >= ESP32TOUCH_MAX_SLIDERS) {
+        touch_log(TOO_MANY_SLIDERS);
+        return false;
+    }
+    if (threshold_percent < 1 || threshold_percent > 99) {
+        touch_log(INVALID_SLIDER_THRESHOLD, threshold_percent);
+        return false;
+    }
+    Slider &slider = sliders[num_sliders];
+    if (!slider.engine.configure(pads, num_pads, wheel, threshold_percent)) {
+        touch_log(UNSUPPORTED_SLIDER_PADS, num_pads);
+        return false;
+    }
+    slider.callback = callback;
+    ++num_sliders;
+    for (int n=0; n<num_pads; ++n) {
+        const int i = pads[n];
+        enabled_mask |= 1u << i;
+        pad_config[i].threshold_percent = threshold_percent;
+        pad_config[i].release_percent = threshold_percent;
+    }
+    return true;
+}
+
+void ESP32Touch::clearSliders()
+{
+    num_sliders = 0;
+    for (int n=0; n<ESP32TOUCH_MAX_SLIDERS; ++n) {
+        sliders[n].callback = nullptr;
+    }
 }
 
 void ESP32Touch::calibrate_thresholds() {
     uint16_t touch_value;
     for (int i=0; i<TOUCH_PAD_MAX; ++i) {
-        if (s_pad_enabled[i]) {
+        if (isEnabled(i)) {
             //read filtered value
             touch_pad_read_filtered(static_cast<touch_pad_t>(i), &touch_value);
-            debug_print_sv("Current touch input: ", i);
-            debug_print_sv("touch pad val is: ", touch_value);
-            s_pad_threshold[i] = static_cast<uint32_t>(touch_value)
-                    * s_pad_threshold_percent[i] / 100;
-            debug_print_sv("threshold value is: ", s_pad_threshold[i]);
+            pad_sense[i].baseline.reset(touch_value);
+            updateThreshold(i);
+            tracked_mask |= 1u << i;
+            touch_log(CALIBRATE_INPUT, i, touch_value, pad_sense[i].threshold);
         }
     }
+    if (interrupt_mode) {
+        programHardwareThresholds();
+    }
+}
+
+bool ESP32Touch::startCalibration(CalibrationCallbackT on_complete)
+{
+    if (calibration.state.load(std::memory_order_acquire) != CALIBRATION_IDLE) {
+        return false;
+    }
+    calibration.callback = on_complete;
+    calibration.pad_mask = enabled_mask;
+    calibration.skip = calibration_settle_samples;
+    calibration.count = 0;
+    calibration.target = calibration_samples < ESP32TOUCH_CALIBRATION_MAX_SAMPLES
+                           ? calibration_samples : ESP32TOUCH_CALIBRATION_MAX_SAMPLES;
+    if (calibration.target == 0) {
+        calibration.target = 1;
+    }
+    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+        calibration.buffer[i].clear();
+    }
+    // Hands the above over to the dispatcher
+    calibration.state.store(CALIBRATION_COLLECTING, std::memory_order_release);
+    // In interrupt mode, this arms the dispatcher. Wake the task if idle.
+    TaskHandle_t task = dispatcher_task_handle.load(std::memory_order_relaxed);
+    if (task) {
+        xTaskNotifyGive(task);
+    }
+    return true;
+}
+
+bool ESP32Touch::calibrationRunning()
+{
+    return calibration.state.load(std::memory_order_acquire) != CALIBRATION_IDLE;
+}
+
+void ESP32Touch::setBaseline(const int input_number, const uint16_t baseline)
+{
+    pad_sense[input_number].baseline.reset(baseline);
+    updateThreshold(input_number);
+    tracked_mask |= 1u << input_number;
 }
 
 void ESP32Touch::begin() {
     for (int i=0; i<TOUCH_PAD_MAX; ++i) {
-        if (s_pad_enabled[i]) {
+        if (isEnabled(i)) {
             touch_pad_config(static_cast<touch_pad_t>(i), threshold_inactive);
         }
     }
     // Initialize and start a software filter to detect slight change of capacitance.
     touch_pad_filter_start(filter_period);
+    registerInstance();
     touch_pad_set_filter_read_cb(filter_read_cb);
+    interrupt_mode = use_touch_interrupt;
+    applySettings();
     // Set threshold
-    calibrate_thresholds();
+    if (calibrate_on_begin) {
+        calibrate_thresholds();
+    } else if (use_touch_interrupt) {
+        // Restored via setBaseline(), or inactive until calibrated
+        programHardwareThresholds();
+    }
+    if (use_touch_interrupt) {
+        enableTouchInterrupt();
+    }
     enableEventTimer();
 }
 
+void ESP32Touch::beginDetached() {
+    interrupt_mode = false;
+    applySettings();
+}
+
+void ESP32Touch::applySettings() {
+    if (!active_cycle_ms.load(std::memory_order_relaxed)) {
+        setDispatchCycleTime(dispatch_cycle_time_ms);
+    }
+    baseline_shift = baseline_tracking_shift;
+    if (baseline_shift > BaselineTracker::MAX_SHIFT) {
+        baseline_shift = BaselineTracker::MAX_SHIFT;
+    }
+    press_debounce = press_debounce_samples;
+    release_debounce = release_debounce_samples;
+}
+
 void ESP32Touch::diagnostics() {
+    const Sample sample = latest_sample.load();
     for (int i=0; i<TOUCH_PAD_MAX; ++i) {
-        if (s_pad_enabled[i]) {
+        if (isEnabled(i)) {
             Serial.print("Button no.: "); Serial.print(i);
             Serial.print(F("  Current sensor value: "));
-            Serial.print(s_pad_filtered_value[i]);
+            Serial.print(sample.filtered_value[i]);
+            Serial.print(F("  Baseline: "));
+            Serial.print(pad_sense[i].baseline.baseline());
             Serial.print(F("  Threshold: "));
-            Serial.println(s_pad_threshold[i]);
+            Serial.print(pad_sense[i].threshold);
+            Serial.print(F("  Release threshold: "));
+            Serial.println(pad_sense[i].release_threshold);
         }
     }
 }
 
+ESP32Touch::Sample ESP32Touch::getLatestSample() {
+    return latest_sample.load();
+}
+
+uint16_t ESP32Touch::getBaseline(const int input_number) {
+    return pad_sense[input_number].baseline.baseline();
+}
+
+uint16_t ESP32Touch::getNoise(const int input_number) {
+    return pad_config[input_number].noise;
+}
+
+void ESP32Touch::feedFilterOutput(const uint16_t *filtered_value, const uint32_t timestamp_ms,
+                                  const uint16_t *raw_value)
+{
+    handleFilterOutput(raw_value ? raw_value : filtered_value, filtered_value,
+                       timestamp_ms
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+                       , timestamp_ms * 1000
+#endif
+                       );
+}
+
+void ESP32Touch::startTrace(TraceRecorder &recorder)
+{
+    stopTrace();
+    recorder.start(enabled_mask);
+    trace_recorder.store(&recorder, std::memory_order_release);
+}
+
+void ESP32Touch::stopTrace()
+{
+    if (trace_recorder.exchange(nullptr, std::memory_order_acq_rel)) {
+        // Let a filter callback still using the recorder finish
+        while (s_instance_users.load()) {
+            vTaskDelay(1);
+        }
+    }
+}
+
+int ESP32Touch::processQueuedSamples()
+{
+    return dispatch_callbacks();
+}
+
 //////// ESP32Touch private:
 
 // Static members must be explicitly initialised
-uint8_t ESP32Touch::s_pad_threshold_percent[TOUCH_PAD_MAX];
-bool ESP32Touch::s_pad_enabled[TOUCH_PAD_MAX];
-bool ESP32Touch::s_pad_active[TOUCH_PAD_MAX][NUM_STATES_DONT_USE];
-uint16_t ESP32Touch::s_pad_filtered_value[TOUCH_PAD_MAX];
-uint16_t ESP32Touch::s_pad_threshold[TOUCH_PAD_MAX];
-CallbackT ESP32Touch::s_pad_callback[TOUCH_PAD_MAX][NUM_STATES_DONT_USE];
-ESP32Touch::BUTTON_STATE ESP32Touch::s_pad_state[TOUCH_PAD_MAX];
-ESP32Touch::INSTANTANEOUS_BUTTON_STATE ESP32Touch::s_pad_instantaneous_state[TOUCH_PAD_MAX];
-long ESP32Touch::s_pad_initial_press_time[TOUCH_PAD_MAX];
-ESP32Touch::TRIGGER_MODE ESP32Touch::s_pad_trigger_mode[TOUCH_PAD_MAX];
+constexpr uint32_t ESP32Touch::DEFAULT_PRESS_TIMES_MS[NUM_STATES_DONT_USE];
+std::atomic<ESP32Touch *> ESP32Touch::s_instances[ESP32TOUCH_MAX_INSTANCES];
+std::atomic<uint32_t> ESP32Touch::s_instance_users{0};
+bool ESP32Touch::s_isr_registered = false;
 
 void ESP32Touch::filter_read_cb(uint16_t *raw_value, uint16_t *filtered_value)
 {
+    const uint32_t timestamp_ms = millis();
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+    const uint32_t timestamp_us = micros();
+#endif
+    s_instance_users.fetch_add(1);
+    for (int n=0; n<ESP32TOUCH_MAX_INSTANCES; ++n) {
+        ESP32Touch *instance = s_instances[n].load();
+        if (instance) {
+            instance->handleFilterOutput(raw_value, filtered_value, timestamp_ms
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+                                         , timestamp_us
+#endif
+                                         );
+        }
+    }
+    s_instance_users.fetch_sub(1, std::memory_order_release);
+}
+
+void ESP32Touch::handleFilterOutput(const uint16_t *raw_value,
+                                    const uint16_t *filtered_value,
+                                    const uint32_t timestamp_ms
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+                                    , const uint32_t timestamp_us
+#endif
+                                    )
+{
+    TraceRecorder *recorder = trace_recorder.load(std::memory_order_acquire);
+    if (recorder) {
+        recorder->record(raw_value, filtered_value, timestamp_ms);
+    }
+    if (calibration.state.load(std::memory_order_acquire) == CALIBRATION_READY) {
+        applyCalibration();
+    }
+    Sample sample;
+    sample.timestamp_ms = timestamp_ms;
+    const uint16_t touched_before = debounced_mask & enabled_mask;
+    uint16_t touched = 0;
+    // Below the release threshold, i.e. touched or about to be
+    uint16_t near_mask = 0;
+    uint16_t approach = 0;
+    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+        sample.filtered_value[i] = filtered_value[i];
+        sample.baseline[i] = pad_sense[i].baseline.baseline();
+        if (filtered_value[i] < pad_sense[i].release_threshold) {
+            near_mask |= 1u << i;
+        }
+        if (filtered_value[i] < pad_sense[i].approach_threshold) {
+            approach |= 1u << i;
+        }
+        if (getInstantaneousButtonState(i, filtered_value[i],
+                                        touched_before & (1u << i)) == PRESSED) {
+            touched |= 1u << i;
+        }
+    }
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+    // Latency counts from the raw threshold crossing, i.e. from the first
+    // sample of the debounce run leading to a state change
+    uint16_t pads = (touched ^ touched_before) & enabled_mask & ~debouncing_mask;
+    while (pads) {
+        const int i = __builtin_ctz(pads);
+        pads &= pads - 1;
+        pad_sense[i].crossing_time_us = timestamp_us;
+    }
+#endif
+    sample.touched_mask = debounceTouchedMask(touched & enabled_mask);
+#if ESP32TOUCH_LATENCY_HISTOGRAM
     for (int i=0; i<TOUCH_PAD_MAX; ++i) {
-        s_pad_filtered_value[i] = filtered_value[i];
+        sample.edge_time_us[i] = pad_sense[i].crossing_time_us;
+    }
+#endif
+    sample.approach_mask = approach & enabled_mask;
+    trackBaselines(filtered_value, near_mask & enabled_mask);
+    latest_sample.store(sample);
+    if (interrupt_mode.load(std::memory_order_relaxed) && !dispatcherArmed()) {
+        // Nobody touching, nothing to queue
+        return;
+    }
+    const uint32_t active_ms = active_cycle_ms.load(std::memory_order_relaxed);
+    if (active_ms && sample.approach_mask
+            && cycle_ms.load(std::memory_order_relaxed) != active_ms) {
+        cycle_ms.store(active_ms, std::memory_order_relaxed);
+        // Cut the current idle cycle short
+        TaskHandle_t task = dispatcher_task_handle.load(std::memory_order_relaxed);
+        if (task) {
+            xTaskNotifyGive(task);
+        }
     }
+    // On overrun, the sample is dropped and counted by the ring
+    sample_ring.push(sample);
 }
 
-enum ESP32Touch::INSTANTANEOUS_BUTTON_STATE ESP32Touch::getInstantaneousButtonState(const int touch_pin)
+void ESP32Touch::trackBaselines(const uint16_t *filtered_value, const uint16_t near_mask)
 {
-    return s_pad_filtered_value[touch_pin] < s_pad_threshold[touch_pin] ? PRESSED : NOT_PRESSED;
+    if (!baseline_shift) {
+        return;
+    }
+    // Baselines are frozen while touched or below the release threshold
+    uint16_t pads = tracked_mask & enabled_mask & ~near_mask;
+    while (pads) {
+        const int i = __builtin_ctz(pads);
+        pads &= pads - 1;
+        if (pad_sense[i].baseline.update(filtered_value[i], baseline_shift)) {
+            updateThreshold(i);
+            if (interrupt_mode.load(std::memory_order_relaxed)) {
+                touch_pad_set_thresh(static_cast<touch_pad_t>(i), pad_sense[i].threshold);
+            }
+        }
+    }
 }
 
-void ESP32Touch::updateButtonState(const int touch_pin)
+uint16_t ESP32Touch::debounceTouchedMask(const uint16_t touched)
 {
-    INSTANTANEOUS_BUTTON_STATE lastButtonState = s_pad_instantaneous_state[touch_pin];
-    INSTANTANEOUS_BUTTON_STATE currentButtonState = getInstantaneousButtonState(touch_pin);
-   
+    const uint16_t changed = (touched ^ debounced_mask) & enabled_mask;
+    // Pads back to their debounced state start over
+    uint16_t pads = debouncing_mask & ~changed;
+    while (pads) {
+        const int i = __builtin_ctz(pads);
+        pads &= pads - 1;
+        pad_sense[i].debounce_count = 0;
+    }
+    debouncing_mask = changed;
+    pads = changed;
+    while (pads) {
+        const int i = __builtin_ctz(pads);
+        const uint16_t pad_bit = 1u << i;
+        pads &= pads - 1;
+        const uint8_t required = debounced_mask & pad_bit ? release_debounce
+                                                          : press_debounce;
+        if (++pad_sense[i].debounce_count >= required) {
+            debounced_mask ^= pad_bit;
+            debouncing_mask &= ~pad_bit;
+            pad_sense[i].debounce_count = 0;
+        }
+    }
+    return debounced_mask &= enabled_mask;
+}
+
+void ESP32Touch::applyCalibration()
+{
+    // All pads switch over between two filter periods
+    const bool interrupt_driven = interrupt_mode.load(std::memory_order_relaxed);
+    uint16_t pads = calibration.calibrated_mask;
+    while (pads) {
+        const int i = __builtin_ctz(pads);
+        pads &= pads - 1;
+        pad_sense[i].baseline.reset(calibration.result[i]);
+        updateThreshold(i);
+        tracked_mask |= 1u << i;
+        if (interrupt_driven) {
+            touch_pad_set_thresh(static_cast<touch_pad_t>(i), pad_sense[i].threshold);
+        }
+    }
+    calibration.state.store(CALIBRATION_APPLIED, std::memory_order_release);
+}
+
+void ESP32Touch::collectCalibrationSample(const Sample &sample)
+{
+    if (calibration.skip) {
+        --calibration.skip;
+        return;
+    }
+    uint16_t pads = calibration.pad_mask;
+    while (pads) {
+        const int i = __builtin_ctz(pads);
+        pads &= pads - 1;
+        calibration.buffer[i].add(sample.filtered_value[i]);
+    }
+    if (++calibration.count < calibration.target) {
+        return;
+    }
+    calibration.calibrated_mask = 0;
+    pads = calibration.pad_mask;
+    while (pads) {
+        const int i = __builtin_ctz(pads);
+        pads &= pads - 1;
+        if (calibration.buffer[i].evaluate(calibration.result[i], pad_config[i].noise)) {
+            calibration.calibrated_mask |= 1u << i;
+            touch_log(CALIBRATED_INPUT, i, calibration.result[i], pad_config[i].noise);
+        } else {
+            touch_log(CALIBRATION_OUTLIERS, i);
+        }
+    }
+    // Hands the result over to the filter callback
+    calibration.state.store(CALIBRATION_READY, std::memory_order_release);
+}
+
+void ESP32Touch::finishCalibration()
+{
+    // Copied so that the callback can start another calibration
+    const CalibrationCallbackT on_complete = calibration.callback;
+    const uint16_t calibrated_mask = calibration.calibrated_mask;
+    calibration.callback = nullptr;
+    calibration.state.store(CALIBRATION_IDLE, std::memory_order_release);
+    if (on_complete) {
+        on_complete(calibrated_mask);
+    }
+}
+
+void ESP32Touch::updateThreshold(const int touch_pin)
+{
+    const uint32_t baseline = pad_sense[touch_pin].baseline.baseline();
+    pad_sense[touch_pin].threshold = baseline * pad_config[touch_pin].threshold_percent / 100;
+    pad_sense[touch_pin].release_threshold = baseline * pad_config[touch_pin].release_percent / 100;
+    const uint32_t threshold = pad_sense[touch_pin].threshold;
+    pad_sense[touch_pin].approach_threshold = threshold + (baseline - threshold)
+                                                          * (100 - approach_percent) / 100;
+}
+
+void IRAM_ATTR ESP32Touch::touch_isr(void * /* arg */)
+{
+    const uint32_t pad_status = touch_pad_get_status();
+    touch_pad_clear_status();
+    if (!pad_status) {
+        return;
+    }
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    s_instance_users.fetch_add(1);
+    for (int n=0; n<ESP32TOUCH_MAX_INSTANCES; ++n) {
+        ESP32Touch *instance = s_instances[n].load();
+        if (!instance || !(pad_status & instance->enabled_mask)
+                || !instance->interrupt_mode.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        instance->wake_seq.fetch_add(1, std::memory_order_release);
+        TaskHandle_t task = instance->dispatcher_task_handle.load(std::memory_order_relaxed);
+        if (task) {
+            vTaskNotifyGiveFromISR(task, &higher_priority_task_woken);
+        }
+    }
+    s_instance_users.fetch_sub(1, std::memory_order_release);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+void ESP32Touch::dispatcher_task(void *arg)
+{
+    ESP32Touch *self = static_cast<ESP32Touch *>(arg);
+    TickType_t last_wake = xTaskGetTickCount();
+    while (self->dispatcher_task_running.load()) {
+        if (self->interrupt_mode.load(std::memory_order_relaxed) && !self->dispatcherArmed()
+                && !self->cycle_callback) {
+            // Sleep until the touch ISR reports a threshold crossing
+            if (self->rearm_mask) {
+                self->rearmReleasedPads();
+            }
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            last_wake = xTaskGetTickCount();
+        } else {
+            // Like vTaskDelayUntil(), but adaptive dispatch can wake the
+            // task early when switching to the active period
+            TickType_t period = pdMS_TO_TICKS(self->cycle_ms.load(std::memory_order_relaxed));
+            period = period ? period : 1;
+            const TickType_t elapsed = xTaskGetTickCount() - last_wake;
+            if (elapsed < period && ulTaskNotifyTake(pdTRUE, period - elapsed)) {
+                last_wake = xTaskGetTickCount();
+            } else {
+                last_wake += period;
+            }
+        }
+        self->dispatch_callbacks();
+    }
+    // The task must not delete itself: stopDispatcherTask() may still
+    // notify it. It is deleted by reapDispatcherTask() instead.
+    xSemaphoreGive(self->dispatcher_task_done);
+    for (;;) {
+        vTaskSuspend(nullptr);
+    }
+}
+
+bool ESP32Touch::dispatcherArmed()
+{
+    // A running calibration needs the sample stream, too
+    return wake_seq.load(std::memory_order_acquire)
+           != idle_seq.load(std::memory_order_acquire)
+           || calibration.state.load(std::memory_order_relaxed) != CALIBRATION_IDLE;
+}
+
+void ESP32Touch::enableTouchInterrupt()
+{
+    touch_pad_set_trigger_mode(TOUCH_TRIGGER_BELOW);
+    if (!s_isr_registered) {
+        touch_pad_isr_register(touch_isr, nullptr);
+        s_isr_registered = true;
+    }
+    touch_pad_clear_status();
+    touch_pad_intr_enable();
+}
+
+void ESP32Touch::disableTouchInterrupt()
+{
+    interrupt_mode = false;
+    if (!s_isr_registered) {
+        return;
+    }
+    // The ISR is shared, keep it while other instances use it
+    for (int n=0; n<ESP32TOUCH_MAX_INSTANCES; ++n) {
+        ESP32Touch *instance = s_instances[n].load();
+        if (instance && instance->interrupt_mode.load()) {
+            return;
+        }
+    }
+    touch_pad_intr_disable();
+    touch_pad_isr_deregister(touch_isr, nullptr);
+    s_isr_registered = false;
+}
+
+void ESP32Touch::registerInstance()
+{
+    ESP32Touch *expected = nullptr;
+    for (int n=0; n<ESP32TOUCH_MAX_INSTANCES; ++n) {
+        if (s_instances[n].load() == this) {
+            return;
+        }
+    }
+    for (int n=0; n<ESP32TOUCH_MAX_INSTANCES; ++n) {
+        if (s_instances[n].compare_exchange_strong(expected, this)) {
+            return;
+        }
+        expected = nullptr;
+    }
+    touch_log(TOO_MANY_INSTANCES);
+}
+
+bool ESP32Touch::unregisterInstance()
+{
+    bool was_registered = false;
+    bool any_registered = false;
+    for (int n=0; n<ESP32TOUCH_MAX_INSTANCES; ++n) {
+        ESP32Touch *expected = this;
+        was_registered |= s_instances[n].compare_exchange_strong(expected, nullptr);
+        any_registered |= s_instances[n].load() != nullptr;
+    }
+    if (!any_registered) {
+        touch_pad_set_filter_read_cb(nullptr);
+    }
+    return was_registered;
+}
+
+void ESP32Touch::programHardwareThresholds()
+{
+    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+        if (isEnabled(i)) {
+            touch_pad_set_thresh(static_cast<touch_pad_t>(i), pad_sense[i].threshold);
+        }
+    }
+}
+
+bool ESP32Touch::allButtonsReleased()
+{
+    // A released pad is always in the NO_PRESS state
+    return pressed_mask.load(std::memory_order_relaxed) == 0;
+}
+
+enum ESP32Touch::INSTANTANEOUS_BUTTON_STATE ESP32Touch::getInstantaneousButtonState(const int touch_pin,
+                                                                                    const uint16_t filtered_value,
+                                                                                    const bool was_touched)
+{
+    // Hysteresis: a touched pad is released above the release threshold
+    const uint16_t threshold = was_touched ? pad_sense[touch_pin].release_threshold
+                                           : pad_sense[touch_pin].threshold;
+    return filtered_value < threshold ? PRESSED : NOT_PRESSED;
+}
+
+void ESP32Touch::updateButtonState(const int touch_pin, const Sample &sample)
+{
+    const uint16_t pad_bit = 1u << touch_pin;
+    uint16_t pressed = pressed_mask.load(std::memory_order_relaxed);
+    INSTANTANEOUS_BUTTON_STATE lastButtonState = pressed & pad_bit ? PRESSED : NOT_PRESSED;
+    INSTANTANEOUS_BUTTON_STATE currentButtonState = sample.touched_mask & pad_bit ? PRESSED : NOT_PRESSED;
+
 
     if(currentButtonState == PRESSED)
     {
         if(lastButtonState == NOT_PRESSED)
         {
-            s_pad_initial_press_time[touch_pin] = millis();
+            startPressTiming(touch_pin, sample.timestamp_ms);
         }
         else if(lastButtonState == PRESSED)
         {
-            long timeDiff = millis() - s_pad_initial_press_time[touch_pin];
-            debug_print_sv("Time difference ", timeDiff);
-            if(timeDiff >= BUTTON_THRESHOLD_TIMES_MS[LONG_PRESSED])
-            {
-                s_pad_state[touch_pin] = LONG_PRESSED;
-            }
-            else if(timeDiff >= BUTTON_THRESHOLD_TIMES_MS[MEDIUM_PRESSED])
-            {
-                s_pad_state[touch_pin] = MEDIUM_PRESSED;
-            }
-            else if(timeDiff >= BUTTON_THRESHOLD_TIMES_MS[SHORT_PRESSED])
-            {
-                s_pad_state[touch_pin] = SHORT_PRESSED;
-            }
+            touch_log(PRESS_TIME, touch_pin,
+                      sample.timestamp_ms - pad_press[touch_pin].initial_press_time);
+        }
+        // Wrap-around safe "deadline reached" comparison. Loops only
+        // when one sample crosses more than one state deadline.
+        while(static_cast<int32_t>(sample.timestamp_ms
+                                   - pad_press[touch_pin].next_deadline_ms) >= 0
+              && pad_press[touch_pin].next_state != NUM_STATES_DONT_USE)
+        {
+            pad_press[touch_pin].state_delay_ms = pad_press[touch_pin].next_deadline_ms
+                                                  - pad_press[touch_pin].initial_press_time;
+            pad_press[touch_pin].state = pad_press[touch_pin].next_state;
+            setNextDeadline(touch_pin);
         }
     }
     else
     {
-        s_pad_state[touch_pin] = NO_PRESS;
+        pad_press[touch_pin].state = NO_PRESS;
         for(int i=0;i<NUM_STATES_DONT_USE;++i)
         {
-            s_pad_active[touch_pin][i] = true;
+            active_mask[i] |= pad_bit;
         }
+        rearm_mask &= ~pad_bit;
+    }
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+    if(currentButtonState != lastButtonState)
+    {
+        pad_press[touch_pin].edge_time_us = sample.edge_time_us[touch_pin];
     }
-    s_pad_instantaneous_state[touch_pin] = currentButtonState;
+#endif
+    if(currentButtonState == PRESSED)
+    {
+        pressed |= pad_bit;
+    }
+    else
+    {
+        pressed &= ~pad_bit;
+    }
+    pressed_mask.store(pressed, std::memory_order_relaxed);
+}
+
+void ESP32Touch::startPressTiming(const int touch_pin, const uint32_t timestamp_ms)
+{
+    pad_press[touch_pin].initial_press_time = timestamp_ms;
+    pad_press[touch_pin].state = NO_PRESS;
+    setNextDeadline(touch_pin);
+    if(repeat_mask & (1u << touch_pin))
+    {
+        pad_press[touch_pin].repeat_deadline_ms = timestamp_ms
+                                                  + pad_config[touch_pin].repeat_delay_ms;
+        pad_press[touch_pin].repeat_interval_ms = pad_config[touch_pin].repeat_interval_ms;
+        pad_press[touch_pin].repeat_count = 0;
+    }
+}
+
+void ESP32Touch::setNextDeadline(const int touch_pin)
+{
+    const BUTTON_STATE state = pad_press[touch_pin].state;
+    if(state == LONG_PRESSED)
+    {
+        // Final state, deadline is never checked again during this press
+        pad_press[touch_pin].next_state = NUM_STATES_DONT_USE;
+        return;
+    }
+    const BUTTON_STATE next = static_cast<BUTTON_STATE>(state + 1);
+    uint32_t press_time_ms = pad_config[touch_pin].press_time_ms[next];
+    if(next == SHORT_PRESSED && pad_config[touch_pin].chord_skew_ms > press_time_ms)
+    {
+        // Leave time for the other pads of a chord, see configure_chord()
+        press_time_ms = pad_config[touch_pin].chord_skew_ms;
+    }
+    pad_press[touch_pin].next_state = next;
+    pad_press[touch_pin].next_deadline_ms = pad_press[touch_pin].initial_press_time
+                                            + press_time_ms;
+}
+
+void ESP32Touch::recordCallbackLatency(const int touch_pin, const uint32_t nominal_delay_ms)
+{
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+    const int32_t latency_us = static_cast<int32_t>(
+            static_cast<uint32_t>(micros()) - pad_press[touch_pin].edge_time_us
+            - nominal_delay_ms * 1000);
+    pad_latency[touch_pin].record(latency_us > 0 ? latency_us : 0);
+#else
+    (void)touch_pin;
+    (void)nominal_delay_ms;
+#endif
+}
+
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+uint32_t ESP32Touch::getLatencyPercentile_us(const int input_number, const uint8_t percent)
+{
+    return pad_latency[input_number].percentile_us(percent);
+}
+
+uint32_t ESP32Touch::getLatencyMax_us(const int input_number)
+{
+    return pad_latency[input_number].max();
 }
 
+uint32_t ESP32Touch::getLatencyCount(const int input_number)
+{
+    return pad_latency[input_number].count();
+}
+
+void ESP32Touch::resetLatencyHistograms()
+{
+    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
+        pad_latency[i].reset();
+    }
+}
+#endif
+
 long ESP32Touch::getTimeSinceLastCallback_ms()
 {
     if(timeOfLastCallback_ms == 0)
@@ -223,41 +1159,381 @@ long ESP32Touch::getTimeSinceLastCallback_ms()
     }
 }
 
-void ESP32Touch::dispatch_callbacks() {
-    for (int i=0; i<TOUCH_PAD_MAX; ++i) {
-        if (s_pad_enabled[i]) {
-            BUTTON_STATE lastButtonState = s_pad_state[i];
-            updateButtonState(i);
-            if(s_pad_active[i][s_pad_state[i]])
+uint16_t ESP32Touch::pressedMask()
+{
+    return pressed_mask.load(std::memory_order_relaxed);
+}
+
+uint32_t ESP32Touch::getSampleOverrunCount()
+{
+    return sample_ring.overruns();
+}
+
+int ESP32Touch::dispatch_callbacks() {
+    const bool interrupt_driven = interrupt_mode.load(std::memory_order_relaxed);
+    if (interrupt_driven && !dispatcherArmed()) {
+        // Idle until the touch ISR reports a threshold crossing. No samples
+        // are dispatched meanwhile, so the pads waiting for their first
+        // release (waitForRelease) would only see it after a touch.
+        if (rearm_mask) {
+            rearmReleasedPads();
+        }
+        if (cycle_callback) {
+            cycle_callback(millis());
+        }
+        return 0;
+    }
+    const uint32_t wake = wake_seq.load(std::memory_order_acquire);
+    // Run the detection over every sample queued since the last cycle
+    int num_samples = 0;
+    Sample sample;
+    while (sample_ring.pop(sample)) {
+        if (calibration.state.load(std::memory_order_acquire) == CALIBRATION_COLLECTING) {
+            collectCalibrationSample(sample);
+        }
+        dispatch_sample(sample);
+        ++num_samples;
+    }
+    if (calibration.state.load(std::memory_order_acquire) == CALIBRATION_APPLIED) {
+        finishCalibration();
+    }
+    if (cycle_callback) {
+        cycle_callback(num_samples ? sample.timestamp_ms : millis());
+    }
+    // Back to idle, unless the ISR fired again in the meantime. At least one
+    // sample taken after the wake-up must have shown all pads released,
+    // and no tap sequence may wait for its deadline.
+    if (interrupt_driven && num_samples && allButtonsReleased() && !tap_pending_mask) {
+        idle_seq.store(wake, std::memory_order_release);
+    }
+    // Adaptive dispatch slows down under the same conditions, and only
+    // once the pads have left the approach zone
+    if (active_cycle_ms.load(std::memory_order_relaxed) && num_samples
+            && !sample.approach_mask && allButtonsReleased() && !tap_pending_mask
+            && calibration.state.load(std::memory_order_relaxed) == CALIBRATION_IDLE) {
+        cycle_ms.store(idle_cycle_ms.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+    }
+    return num_samples;
+}
+
+void ESP32Touch::rearmReleasedPads()
+{
+    const uint16_t released = rearm_mask & ~latest_sample.load().touched_mask;
+    for (int i=0; i<NUM_STATES_DONT_USE; ++i) {
+        active_mask[i] |= released;
+    }
+    rearm_mask &= ~released;
+}
+
+void ESP32Touch::dispatch_sample(const Sample &sample) {
+    if(num_chords)
+    {
+        matchChords(sample);
+    }
+    for(int n=0; n<num_sliders; ++n)
+    {
+        Slider &slider = sliders[n];
+        if(slider.engine.update(sample.filtered_value, sample.baseline,
+                                sample.timestamp_ms)
+           && slider.callback)
+        {
+            slider.callback(slider.engine.current());
+        }
+    }
+    // Only pads which are touched now, were touched before or wait for their
+    // first release can change state. Visit these only, lowest pad first.
+    // Pads waiting for their next tap are visited to check the deadline.
+    uint16_t pending = enabled_mask
+                       & (sample.touched_mask | rearm_mask | tap_pending_mask
+                          | pressed_mask.load(std::memory_order_relaxed));
+    while (pending) {
+        const int i = __builtin_ctz(pending);
+        pending &= pending - 1;
+        BUTTON_STATE lastButtonState = pad_press[i].state;
+        updateButtonState(i, sample);
+        if(chord_captured_mask & (1u << i))
+        {
+            // Part of a recognised chord until released, no own callbacks
+            if(!(sample.touched_mask & (1u << i)))
             {
-                if(s_pad_trigger_mode[i] == RISE && s_pad_state[i] != NO_PRESS)
+                chord_captured_mask &= ~(1u << i);
+            }
+            continue;
+        }
+        // First, so that taps before a hold are reported before the hold
+        if(multi_tap_mask & (1u << i))
+        {
+            updateTapState(i, lastButtonState, sample);
+        }
+        // Single taps of these pads are reported by emitTaps()
+        const bool short_deferred = tap_suppress_mask & (1u << i);
+        if(active_mask[pad_press[i].state] & (1u << i))
+        {
+            if(pad_press[i].trigger_mode == RISE && pad_press[i].state != NO_PRESS
+               && !(short_deferred && pad_press[i].state == SHORT_PRESSED))
+            {
+                const BUTTON_STATE state = pad_press[i].state;
+                if(lastButtonState != state && hasCallback(i, state))
                 {
-                    if(lastButtonState != s_pad_state[i])
-                    {
-                        CallbackT cb = s_pad_callback[i][s_pad_state[i]];
-                        if (cb)
-                        {
-                            debug_print_sv("Dispatching rising callback for touch input no.: ", i);
-                            timeOfLastCallback_ms = millis();
-                            cb();
-                        }
-                    }
+                    touch_log(RISING_CALLBACK, i);
+                    timeOfLastCallback_ms = millis();
+                    // Includes the chord skew, see setNextDeadline()
+                    recordCallbackLatency(i, pad_press[i].state_delay_ms);
+                    invokeCallback(i, state, RISE, sample);
                 }
-                else if(s_pad_trigger_mode[i] == FALL && s_pad_state[i] == NO_PRESS)
+            }
+            else if(pad_press[i].trigger_mode == FALL && pad_press[i].state == NO_PRESS
+                    && !(short_deferred && lastButtonState == SHORT_PRESSED))
+            {
+                if(lastButtonState != pad_press[i].state && hasCallback(i, lastButtonState))
                 {
-                    if(lastButtonState != s_pad_state[i])
-                    {
-                        CallbackT cb = s_pad_callback[i][lastButtonState];
-                        if (cb)
-                        {
-                            debug_print_sv("Dispatching falling callback for touch input no.: ", i);
-                            timeOfLastCallback_ms = millis();
-                            cb();
-                        }
-                    }
+                    touch_log(FALLING_CALLBACK, i);
+                    timeOfLastCallback_ms = millis();
+                    recordCallbackLatency(i, 0);
+                    invokeCallback(i, lastButtonState, FALL, sample);
                 }
             }
-            
+        }
+        if(repeat_mask & pressed_mask.load(std::memory_order_relaxed) & (1u << i))
+        {
+            updateRepeat(i, sample.timestamp_ms);
+        }
+    }
+}
+
+void ESP32Touch::updateRepeat(const int touch_pin, const uint32_t timestamp_ms)
+{
+    PadPressState &press = pad_press[touch_pin];
+    // Wrap-around safe "deadline reached" comparison
+    if(static_cast<int32_t>(timestamp_ms - press.repeat_deadline_ms) < 0)
+    {
+        return;
+    }
+    const PadConfig &config = pad_config[touch_pin];
+    ++press.repeat_count;
+    press.repeat_deadline_ms += press.repeat_interval_ms;
+    if(static_cast<int32_t>(timestamp_ms - press.repeat_deadline_ms) >= 0)
+    {
+        // Event loop fell behind, continue from now without a burst
+        press.repeat_deadline_ms = timestamp_ms + press.repeat_interval_ms;
+    }
+    const uint16_t step = press.repeat_interval_ms * config.repeat_acceleration_percent / 100;
+    press.repeat_interval_ms = press.repeat_interval_ms - step > config.repeat_min_interval_ms
+                               ? press.repeat_interval_ms - step
+                               : config.repeat_min_interval_ms;
+    touch_log(REPEAT_CALLBACK, touch_pin, press.repeat_count);
+    timeOfLastCallback_ms = millis();
+    config.repeat_callback(press.repeat_count);
+}
+
+void ESP32Touch::matchChords(const Sample &sample)
+{
+    const uint16_t touched = sample.touched_mask;
+    const uint16_t pressed = pressed_mask.load(std::memory_order_relaxed);
+    for(int n=0; n<num_chords; ++n)
+    {
+        const Chord &chord = chords[n];
+        const uint16_t chord_bit = 1u << n;
+        if((touched & chord.pad_mask) != chord.pad_mask)
+        {
+            chord_latched_mask &= ~chord_bit;
+            continue;
+        }
+        if((chord_latched_mask & chord_bit) || (chord_captured_mask & chord.pad_mask))
+        {
+            continue;
+        }
+        // All pads touched for the first time. Evaluated once per press,
+        // as the press start times do not change any more.
+        chord_latched_mask |= chord_bit;
+        // Press age of each pad, pads touched with this sample start now
+        uint32_t oldest_ms = 0;
+        uint32_t newest_ms = UINT32_MAX;
+        uint16_t pads = chord.pad_mask;
+        while(pads)
+        {
+            const int i = __builtin_ctz(pads);
+            pads &= pads - 1;
+            const uint32_t age_ms = pressed & (1u << i)
+                                    ? sample.timestamp_ms - pad_press[i].initial_press_time
+                                    : 0;
+            if(age_ms > oldest_ms)
+            {
+                oldest_ms = age_ms;
+            }
+            if(age_ms < newest_ms)
+            {
+                newest_ms = age_ms;
+            }
+        }
+        if(oldest_ms - newest_ms > chord.skew_ms)
+        {
+            continue;
+        }
+        // Taps of the chord pads before the chord are dropped
+        chord_captured_mask |= chord.pad_mask;
+        tap_pending_mask &= ~chord.pad_mask;
+        pads = chord.pad_mask;
+        while(pads)
+        {
+            const int i = __builtin_ctz(pads);
+            pads &= pads - 1;
+            pad_press[i].tap_count = 0;
+        }
+        if(chord.callback)
+        {
+            touch_log(CHORD_CALLBACK, chord.pad_mask);
+            timeOfLastCallback_ms = millis();
+            chord.callback();
         }
     }
 }
+
+void ESP32Touch::updateTapState(const int touch_pin,
+                                const BUTTON_STATE last_state,
+                                const Sample &sample)
+{
+    const uint32_t timestamp_ms = sample.timestamp_ms;
+    const uint16_t pad_bit = 1u << touch_pin;
+    PadPressState &press = pad_press[touch_pin];
+    if(press.state == NO_PRESS && last_state == SHORT_PRESSED)
+    {
+        // Released as a tap. Report right away if no more taps can follow.
+        if(++press.tap_count >= pad_config[touch_pin].max_taps)
+        {
+            emitTaps(touch_pin, 0, sample);
+            return;
+        }
+        press.tap_deadline_ms = timestamp_ms + pad_config[touch_pin].tap_window_ms;
+        tap_pending_mask |= pad_bit;
+    }
+    else if(press.state >= MEDIUM_PRESSED && press.tap_count)
+    {
+        // A hold ends the sequence, with the taps before it
+        emitTaps(touch_pin, 0, sample);
+    }
+    else if((tap_pending_mask & pad_bit)
+            && !(pressed_mask.load(std::memory_order_relaxed) & pad_bit)
+            && static_cast<int32_t>(timestamp_ms - press.tap_deadline_ms) >= 0)
+    {
+        // No next tap started within the window
+        emitTaps(touch_pin, pad_config[touch_pin].tap_window_ms, sample);
+    }
+}
+
+void ESP32Touch::emitTaps(const int touch_pin, const uint32_t nominal_delay_ms,
+                          const Sample &sample)
+{
+    const uint8_t num_taps = pad_press[touch_pin].tap_count;
+    pad_press[touch_pin].tap_count = 0;
+    tap_pending_mask &= ~(1u << touch_pin);
+    // A deferred single tap goes to the SHORT_PRESSED callback
+    bool single_tap = false;
+    const CallbackT *cb = nullptr;
+    if(num_taps == 1)
+    {
+        single_tap = ((tap_suppress_mask & active_mask[SHORT_PRESSED]) & (1u << touch_pin))
+                     && hasCallback(touch_pin, SHORT_PRESSED);
+    }
+    else if(pad_config[touch_pin].tap_callback[num_taps - 2])
+    {
+        cb = &pad_config[touch_pin].tap_callback[num_taps - 2];
+    }
+    if(!single_tap && !cb)
+    {
+        return;
+    }
+    touch_log(TAP_CALLBACK, touch_pin, num_taps);
+    timeOfLastCallback_ms = millis();
+    recordCallbackLatency(touch_pin, nominal_delay_ms);
+    if(single_tap)
+    {
+        invokeCallback(touch_pin, SHORT_PRESSED, pad_press[touch_pin].trigger_mode, sample);
+    }
+    else
+    {
+        (*cb)();
+    }
+}
+
+void ESP32Touch::setCallback(const int touch_pin, const BUTTON_STATE state,
+                             const CallbackT &callback)
+{
+    clearCallback(touch_pin, state);
+    pad_config[touch_pin].callback[state].plain = callback;
+}
+
+void ESP32Touch::setCallback(const int touch_pin, const BUTTON_STATE state,
+                             const EventCallbackT &callback)
+{
+    clearCallback(touch_pin, state);
+    if(!callback)
+    {
+        return;
+    }
+    StateCallback &slot = pad_config[touch_pin].callback[state];
+    slot.plain.~CallbackT();
+    new (&slot.event) EventCallbackT(callback);
+    event_mask[state] |= 1u << touch_pin;
+}
+
+void ESP32Touch::clearCallback(const int touch_pin, const BUTTON_STATE state)
+{
+    const uint16_t pad_bit = 1u << touch_pin;
+    StateCallback &slot = pad_config[touch_pin].callback[state];
+    if(event_mask[state] & pad_bit)
+    {
+        // Back to the default member, an empty CallbackT
+        slot.event.~EventCallbackT();
+        new (&slot.plain) CallbackT();
+        event_mask[state] &= ~pad_bit;
+    }
+    else
+    {
+        slot.plain = nullptr;
+    }
+}
+
+bool ESP32Touch::hasCallback(const int touch_pin, const BUTTON_STATE state)
+{
+    return ((event_mask[state] | queued_mask[state]) & (1u << touch_pin))
+           || pad_config[touch_pin].callback[state].plain;
+}
+
+void ESP32Touch::invokeCallback(const int touch_pin, const BUTTON_STATE state,
+                                const TRIGGER_MODE edge, const Sample &sample)
+{
+    const PadConfig &config = pad_config[touch_pin];
+    if(!((event_mask[state] | queued_mask[state]) & (1u << touch_pin)))
+    {
+        config.callback[state].plain();
+        return;
+    }
+    TouchEvent event;
+    event.pad = static_cast<uint8_t>(touch_pin);
+    event.state = state;
+    event.edge = edge;
+    event.press_duration_ms = sample.timestamp_ms - pad_press[touch_pin].initial_press_time;
+    event.timestamp_ms = sample.timestamp_ms;
+    event.filtered_value = sample.filtered_value[touch_pin];
+    if(queued_mask[state] & (1u << touch_pin))
+    {
+        if(event_queue.push(event))
+        {
+            const uint32_t depth = event_queue.size();
+            if(depth > event_queue_high_water.load(std::memory_order_relaxed))
+            {
+                event_queue_high_water.store(depth, std::memory_order_relaxed);
+            }
+        }
+        else
+        {
+            touch_log(EVENT_QUEUE_FULL, touch_pin);
+        }
+        xSemaphoreGive(event_semaphore);
+        return;
+    }
+    config.callback[state].event(event);
+}
+
@@ -3,17 +3,116 @@
 #ifndef ESP32_TOUCH_H
 #define ESP32_TOUCH_H
 
+#include <atomic>
 #include <functional>
 #include <driver/touch_pad.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include <Ticker.h> // https://github.com/sstaub/Ticker.git
-#include <map>
+#include "spsc_ring.h"
+#include "seqlock.h"
+#include "inplace_function.h"
+#include "baseline_tracker.h"
+#include "calibration_buffer.h"
+#include "touch_slider.h"
+#include "trace_recorder.h"
 
-// Omit this line to disable debug print output
-#define ENABLE_DEBUG_PRINT 1
-#include "info_debug_error.h"
+/** @brief Number of filter output samples buffered between the filter
+ *         callback and the dispatcher. Must be a power of two.
+ *         With the default 10 ms filter period, 32 samples allow for the
+ *         dispatcher to lag up to 320 ms behind before samples are lost.
+ */
+#ifndef ESP32TOUCH_SAMPLE_RING_SIZE
+#define ESP32TOUCH_SAMPLE_RING_SIZE 32
+#endif
+
+/** @brief Number of touch events buffered for pollEvent() and waitEvent().
+ *         Must be a power of two. Costs 16 bytes of RAM per event.
+ */
+#ifndef ESP32TOUCH_EVENT_QUEUE_SIZE
+#define ESP32TOUCH_EVENT_QUEUE_SIZE 16
+#endif
+
+/** @brief Maximum number of samples per pad for startCalibration(),
+ *         see ESP32Touch::calibration_samples. Costs two bytes of RAM
+ *         per sample and touch pad.
+ */
+#ifndef ESP32TOUCH_CALIBRATION_MAX_SAMPLES
+#define ESP32TOUCH_CALIBRATION_MAX_SAMPLES 32
+#endif
+
+/** @brief Maximum number of ESP32Touch instances attached to the touch
+ *         peripheral at the same time, see ESP32Touch::begin().
+ */
+#ifndef ESP32TOUCH_MAX_INSTANCES
+#define ESP32TOUCH_MAX_INSTANCES 4
+#endif
+
+/** @brief Maximum number of chords per ESP32Touch instance,
+ *         see ESP32Touch::configure_chord(). At most 16.
+ */
+#ifndef ESP32TOUCH_MAX_CHORDS
+#define ESP32TOUCH_MAX_CHORDS 4
+#endif
+static_assert(ESP32TOUCH_MAX_CHORDS <= 16, "ESP32TOUCH_MAX_CHORDS must be at most 16");
+
+/** @brief Maximum number of sliders and wheels per ESP32Touch instance,
+ *         see ESP32Touch::configure_slider().
+ */
+#ifndef ESP32TOUCH_MAX_SLIDERS
+#define ESP32TOUCH_MAX_SLIDERS 2
+#endif
+
+#include "touch_log.h"
+
+/** @brief Set to 1 to record a histogram of the touch-to-callback latency
+ *         for each pad, see ESP32Touch::getLatencyPercentile_us().
+ *         When 0 (default), the instrumentation compiles to nothing.
+ */
+#ifndef ESP32TOUCH_LATENCY_HISTOGRAM
+#define ESP32TOUCH_LATENCY_HISTOGRAM 0
+#endif
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+#include "latency_histogram.h"
+#endif
+
+/** @brief Inline storage in bytes for the captured state of a user callback.
+ *         The default fits e.g. a lambda capturing up to four pointers.
+ */
+#ifndef ESP32TOUCH_CALLBACK_CAPTURE_SIZE
+#define ESP32TOUCH_CALLBACK_CAPTURE_SIZE (4 * sizeof(void *))
+#endif
+
+/** @brief User callback function type.
+ *         This never allocates, larger captures fail to compile.
+ *         A std::function stored in it still keeps its own heap-held
+ *         target, which is copied along with every copy of the wrapper.
+ */
+using CallbackT = InplaceFunction<void(void), ESP32TOUCH_CALLBACK_CAPTURE_SIZE>;
+
+/** @brief Completion callback for ESP32Touch::startCalibration().
+ *         The argument has bit n set if touch pad n was calibrated.
+ */
+using CalibrationCallbackT = InplaceFunction<void(uint16_t),
+                                             ESP32TOUCH_CALLBACK_CAPTURE_SIZE>;
 
-/** @brief User callback function type */
-using CallbackT = std::function<void(void)>;
+/** @brief Auto-repeat callback for ESP32Touch::configure_auto_repeat().
+ *         The argument counts the repeats of the current press from 1.
+ */
+using RepeatCallbackT = InplaceFunction<void(uint16_t),
+                                        ESP32TOUCH_CALLBACK_CAPTURE_SIZE>;
+
+/** @brief End of cycle callback for ESP32Touch::setCycleCallback().
+ *         The argument is the timestamp of the newest sample in ms, or
+ *         millis() if the cycle processed none.
+ */
+using CycleCallbackT = InplaceFunction<void(uint32_t),
+                                       ESP32TOUCH_CALLBACK_CAPTURE_SIZE>;
+
+/** @brief Position update callback for ESP32Touch::configure_slider() */
+using SliderCallbackT = InplaceFunction<void(const TouchSlider::State &),
+                                        ESP32TOUCH_CALLBACK_CAPTURE_SIZE>;
 
 /******************************* ESP32Touch ********************************//**
  * @brief ESP32 touch button driver with async callback interface
@@ -22,27 +121,36 @@ using CallbackT = std::function<void(void)>;
  * ESP32 platform for up to ten non-multiplexed buttons.
  * 
  * All of the operation takes place asynchronously via user-defined
- * callback functions, which can be any type compatible with a C++
- * std::function object, i.e. plain global functions, static and non-static
- * class or instance members or C++11 lambda expressions.
+ * callback functions: plain global or static member functions, or
+ * lambda expressions and other function objects whose captured state fits
+ * into ESP32TOUCH_CALLBACK_CAPTURE_SIZE bytes. Pointers to non-static
+ * members cannot be stored; use a lambda capturing the instance instead.
  * 
  * In contrast to the original Arduino touchRead() function,
  * this implementation works reliably with stable, filtered sensor readout
  * and without false triggers by random spikes/zeros from some hardware
  * or API failure (See: https://forum.arduino.cc/index.php?topic=629955.0)
  * 
- * This API uses the ESP-IDF touch sensor interface, but does not register
- * with the touch hardware ISR interface. Instead, this uses the continuous
- * output from the ESP-IDF touch IIR filter using the filter_read_cb() hook
- * from touch_pad.h.
+ * By default, this API uses the ESP-IDF touch sensor interface, but does
+ * not register with the touch hardware ISR interface. Instead, this uses
+ * the continuous output from the ESP-IDF touch IIR filter using the
+ * filter_read_cb() hook from touch_pad.h.
+ * (See use_touch_interrupt for an interrupt driven alternative.)
+ * Every filter output is timestamped and queued into a lock-free ring
+ * buffer (see ESP32TOUCH_SAMPLE_RING_SIZE).
  * A freeRTOS timer (via Ticker.h) is then set up periodicly calling an event
- * loop handler checking if any button threshold level is reached. If this is
- * the case, it then calls the respective user callback.
+ * loop handler which runs the button state detection over every queued
+ * sample, so that short taps between two event loop cycles are not lost.
+ * If any button threshold level is reached, it then calls the respective
+ * user callback.
  * This has the advantage of not blocking the filter ISR for extended time.
  * 
  * The cycle time for the event checking loop can be configured in the header
  * via dispatch_cycle_time_ms setting, the default is 100 milliseconds.
  * 
+ * All state is owned by the instance, so several independent ESP32Touch
+ * objects can coexist, see begin().
+ * 
  * For the sensor input pins, please again note that the touch API uses
  * a different numbering scheme than the standard GPIO numbers.
  * E.g. touch button no. 0 is GPIO 4.
@@ -60,7 +168,7 @@ public:
         NOT_PRESSED
     };
 
-    enum BUTTON_STATE
+    enum BUTTON_STATE : uint8_t
     {
         NO_PRESS,
         SHORT_PRESSED,
@@ -75,13 +183,107 @@ public:
     // not pressed. Using FALLING can be used to only have a single button 
     // event triggered per button press even if you have multiple button 
     // states configured on a single touch pad.
-    enum TRIGGER_MODE
+    enum TRIGGER_MODE : uint8_t
     {
         RISE,
         FALL
     };
 
-    /** @brief Configure here the cycle time for the event loop/handler
+    /** @brief Default minimum press durations for each BUTTON_STATE in ms,
+     *         see setPressDurations()
+     */
+    static constexpr uint32_t DEFAULT_PRESS_TIMES_MS[NUM_STATES_DONT_USE] = {
+        0,    // NO_PRESS
+        50,   // SHORT_PRESSED
+        300,  // MEDIUM_PRESSED
+        2000  // LONG_PRESSED
+    };
+
+    /** @brief Highest number of consecutive taps reported by
+     *         configure_multi_tap(), i.e. triple taps
+     */
+    static constexpr uint8_t MAX_TAP_COUNT = 3;
+
+    /** @brief Default maximum time in ms from the release of a tap to the
+     *         start of the next tap of a multi-tap, see setMultiTapWindow()
+     */
+    static constexpr uint16_t DEFAULT_MULTI_TAP_WINDOW_MS = 300;
+
+    /** @brief Default maximum time in ms between the first and the last
+     *         pad press of a chord, see configure_chord()
+     */
+    static constexpr uint16_t DEFAULT_CHORD_SKEW_MS = 100;
+
+    /** @brief Defaults for configure_auto_repeat(): delay until the first
+     *         repeat, first and shortest interval in ms, and interval
+     *         reduction per repeat in percent
+     */
+    static constexpr uint16_t DEFAULT_REPEAT_DELAY_MS = 500;
+    static constexpr uint16_t DEFAULT_REPEAT_INTERVAL_MS = 200;
+    static constexpr uint16_t DEFAULT_REPEAT_MIN_INTERVAL_MS = 50;
+    static constexpr uint8_t DEFAULT_REPEAT_ACCELERATION_PERCENT = 10;
+
+    /** @brief Default touch threshold of sliders, see configure_slider() */
+    static constexpr uint8_t DEFAULT_SLIDER_THRESHOLD_PERCENT = 90;
+
+    /** @brief Defaults for setAdaptiveDispatch(): event loop period in ms
+     *         while all pads are idle and while any pad is near its
+     *         threshold, and where "near" starts in percent of the way
+     *         from the baseline to the press threshold
+     */
+    static constexpr uint32_t DEFAULT_IDLE_CYCLE_TIME_MS = 100;
+    static constexpr uint32_t DEFAULT_ACTIVE_CYCLE_TIME_MS = 5;
+    static constexpr uint8_t DEFAULT_APPROACH_PERCENT = 50;
+
+    /** @brief One timestamped IIR filter output for all touch pads */
+    struct Sample
+    {
+        uint32_t timestamp_ms;
+        uint16_t filtered_value[TOUCH_PAD_MAX];
+        /** @brief Idle-state readouts at the time of the sample */
+        uint16_t baseline[TOUCH_PAD_MAX];
+        /** @brief Bit n set if enabled pad n was below its threshold */
+        uint16_t touched_mask;
+        /** @brief Bit n set if enabled pad n was near its threshold,
+         *         see setAdaptiveDispatch()
+         */
+        uint16_t approach_mask;
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+        /** @brief Raw threshold crossing time of the pads whose debounced
+         *         state changed with this sample
+         */
+        uint32_t edge_time_us[TOUCH_PAD_MAX];
+#endif
+    };
+
+    /** @brief Context of a callback registered with the TouchEvent
+     *         overload of configure_input()
+     */
+    struct TouchEvent
+    {
+        uint8_t pad;
+        /** @brief State the callback was registered for */
+        BUTTON_STATE state;
+        TRIGGER_MODE edge;
+        /** @brief Time from the start of the press to timestamp_ms,
+         *         i.e. the full press duration for FALL
+         */
+        uint32_t press_duration_ms;
+        /** @brief Timestamp of the filter sample which caused the event */
+        uint32_t timestamp_ms;
+        /** @brief Filtered readout of the pad in that sample */
+        uint16_t filtered_value;
+    };
+
+    /** @brief User callback type receiving a TouchEvent.
+     *         This never allocates, as CallbackT.
+     */
+    using EventCallbackT = InplaceFunction<void(const TouchEvent &),
+                                           ESP32TOUCH_CALLBACK_CAPTURE_SIZE>;
+
+    /** @brief Configure here the cycle time for the event loop/handler.
+     *         Takes effect with begin(), see setDispatchCycleTime() for
+     *         changing it later.
      */
     uint32_t dispatch_cycle_time_ms = 20;
 
@@ -90,6 +292,67 @@ public:
      */
     int filter_period = 10;
 
+    /** @brief Use the touch sensor hardware interrupt to wake the event loop.
+     * 
+     * When set before begin(), the calibrated thresholds are programmed into
+     * the touch hardware and the event loop stays idle (no sample processing
+     * at all) until the touch ISR reports a threshold crossing. While a press
+     * is in progress, samples are processed every dispatch_cycle_time_ms as
+     * in the default polling mode, so the press duration states are timed
+     * the same way. Once all pads are released, the event loop goes back
+     * to idle.
+     */
+    bool use_touch_interrupt = false;
+
+    /** @brief Time constant of the adaptive baseline tracking as a power of
+     *         two number of filter periods, or 0 to disable tracking.
+     * 
+     * While a pad is not touched, its idle-state readout (baseline) slowly
+     * follows the filter output and the touch threshold is updated from it,
+     * so that sensor drift from temperature or humidity does not cause
+     * phantom presses after hours of uptime. Tracking is frozen while a pad
+     * is touched. The default of 12 gives a time constant of 4096 filter
+     * periods, i.e. about 41 s with the default filter_period.
+     * Values above 16 are treated as 16. Takes effect with begin().
+     */
+    uint8_t baseline_tracking_shift = 12;
+
+    /** @brief When set (default), begin() blocks on calibrate_thresholds().
+     * 
+     * Clear this to start serving presses immediately from baselines
+     * restored via setBaseline(), e.g. persisted from a previous run.
+     * Pads without a restored baseline stay inactive until calibrated,
+     * for example by calling startCalibration() after begin().
+     */
+    bool calibrate_on_begin = true;
+
+    /** @brief Number of samples per pad taken by startCalibration(),
+     *         at most ESP32TOUCH_CALIBRATION_MAX_SAMPLES.
+     */
+    uint8_t calibration_samples = ESP32TOUCH_CALIBRATION_MAX_SAMPLES;
+
+    /** @brief Number of filter output samples discarded by
+     *         startCalibration() before collecting, to let the IIR
+     *         filter settle e.g. right after begin().
+     */
+    uint8_t calibration_settle_samples = 16;
+
+    /** @brief Number of consecutive filter output samples below the press
+     *         threshold before a pad counts as touched.
+     * 
+     * Together with release_debounce_samples and the release threshold
+     * of configure_input(), this suppresses repeated callbacks from a
+     * finger resting near the threshold, at the cost of
+     * (n - 1) * filter_period of latency. Takes effect with begin().
+     */
+    uint8_t press_debounce_samples = 1;
+
+    /** @brief Number of consecutive filter output samples above the release
+     *         threshold before a touched pad counts as released.
+     *         Takes effect with begin().
+     */
+    uint8_t release_debounce_samples = 1;
+
     ESP32Touch();
     virtual ~ESP32Touch();
 
@@ -100,12 +363,137 @@ public:
     void enableEventTimer();
     void updateButtons();
 
+    /** @brief Run the event loop in a dedicated FreeRTOS task.
+     * 
+     * By default, the event loop only runs when updateButtons() is called,
+     * so touch latency depends on how long loop() takes. This creates a
+     * task which instead runs the event loop every dispatch_cycle_time_ms
+     * on an absolute-deadline schedule (vTaskDelayUntil) and stops the
+     * polled event timer. In interrupt driven mode (use_touch_interrupt),
+     * the task sleeps until the touch ISR wakes it.
+     * 
+     * User callbacks then run in this task, on its stack.
+     * Call this after begin().
+     * 
+     * @param priority FreeRTOS task priority
+     * @param stack_size Task stack size in bytes
+     * @param core_id CPU core to pin the task to, or tskNO_AFFINITY
+     * @return true if the task is running
+     */
+    bool startDispatcherTask(const UBaseType_t priority = 5,
+                             const uint32_t stack_size = 4096,
+                             const BaseType_t core_id = tskNO_AFFINITY);
+
+    /** @brief Stop the dispatcher task after its current cycle and return
+     *         to the polled event timer (see updateButtons()).
+     * 
+     * This waits for the task to exit, except when called from a callback,
+     * i.e. from the task itself: it then returns at once, the task ends
+     * after the current cycle and the next updateButtons() call deletes it
+     * and returns to the event timer. startDispatcherTask() fails until then.
+     * The destructor stops the task as well, but must never run from a
+     * callback.
+     */
+    void stopDispatcherTask();
+
+    /** @brief Change the event loop period at runtime, for the polled event
+     *         timer and the dispatcher task alike. Ends adaptive dispatch.
+     * 
+     * The sample queue holds ESP32TOUCH_SAMPLE_RING_SIZE filter periods,
+     * so cycle_ms must stay well below that to not lose samples.
+     * 
+     * @param cycle_ms Event loop period in ms, at least 1
+     */
+    void setDispatchCycleTime(const uint32_t cycle_ms);
+
+    /** @brief Run the event loop slowly while all pads are idle and fast
+     *         while any pad is touched or about to be.
+     * 
+     * The period is idle_cycle_ms until the filtered readout of an enabled
+     * pad gets approach_percent of the way from its baseline down to its
+     * press threshold. The filter callback then switches to active_cycle_ms
+     * at once, waking the dispatcher task early if one runs. Once all pads
+     * are released and back out of this approach zone, and no multi-tap is
+     * pending, the event loop returns to idle_cycle_ms.
+     * 
+     * This saves most of the event loop CPU time (and wake-ups) while
+     * nobody touches the pads, and gives callbacks active_cycle_ms
+     * latency when it matters. Call setDispatchCycleTime() to return to a
+     * fixed period.
+     * 
+     * @param idle_cycle_ms Period in ms while idle, see the sample queue
+     *                      size limit at setDispatchCycleTime()
+     * @param active_cycle_ms Period in ms while any pad is near its
+     *                        threshold, at least 1
+     * @param approach_percent Start of the approach zone, 0 (baseline)
+     *                         to 100 (press threshold)
+     */
+    void setAdaptiveDispatch(const uint32_t idle_cycle_ms = DEFAULT_IDLE_CYCLE_TIME_MS,
+                             const uint32_t active_cycle_ms = DEFAULT_ACTIVE_CYCLE_TIME_MS,
+                             const uint8_t approach_percent = DEFAULT_APPROACH_PERCENT);
+
+    /** @brief Event loop period in ms currently in effect */
+    uint32_t getDispatchCycleTime();
+
+    /** @brief Register a callback run at the end of every event loop
+     *         cycle, after all button callbacks.
+     * 
+     * For code which keeps its own deadlines on the event loop clock,
+     * e.g. the timeouts of AsyncTouch (async_touch.h). In interrupt
+     * driven mode, it is also run while all pads are idle, so the
+     * dispatcher task then wakes every cycle instead of sleeping until
+     * the next touch. Call this before startDispatcherTask() or from a
+     * callback.
+     * 
+     * @param callback Called with the timestamp of the newest sample,
+     *                 nullptr to remove it
+     */
+    void setCycleCallback(CycleCallbackT callback);
+
     /** @brief Get the time in ms since the last callback function was triggered.
      *         useful for detecting button inactivity. Will return -1 if a callback
      *         has never been triggered.
      */
     long getTimeSinceLastCallback_ms();
 
+    /** @brief Number of filter samples lost because the dispatcher did not
+     *         drain the sample ring in time (or the event timer was stopped).
+     *         Any non-zero increase means presses may have been missed.
+     */
+    uint32_t getSampleOverrunCount();
+
+    /** @brief Get the touch state of all pads at once.
+     * 
+     * Bit n is set while touch pad n is touched, as seen by the event loop
+     * when it last ran. This is a single atomic load and can be polled from
+     * any context.
+     */
+    uint16_t pressedMask();
+
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+    /** @brief Touch-to-callback latency percentile in microseconds.
+     * 
+     * The latency is measured from the filter sample in which the pad
+     * first crossed its threshold to the invocation of the user callback.
+     * For rising edge callbacks the press duration after which the state
+     * was entered (for chord pads at least the chord skew) is subtracted,
+     * so this is the delay added by debouncing, the sample queueing and
+     * the event loop cycle alone.
+     * 
+     * The result is the upper bound of the log2 histogram bucket holding
+     * the percentile, i.e. accurate to within a factor of two.
+     * 
+     * @param input_number Touch input pin number
+     * @param percent Percentile, e.g. 50 or 99
+     */
+    uint32_t getLatencyPercentile_us(const int input_number, const uint8_t percent);
+    /** @brief Maximum recorded touch-to-callback latency in microseconds */
+    uint32_t getLatencyMax_us(const int input_number);
+    /** @brief Number of callback invocations recorded for a pad */
+    uint32_t getLatencyCount(const int input_number);
+    void resetLatencyHistograms();
+#endif
+
     /** @brief Configure input pin as a touch input, set threshold value and
      *         register the required user callback called when pin is touched.
      * @param input_number Touch input pin number
@@ -113,10 +501,12 @@ public:
      * @param threshold_percent Touch button touch detection threshold in
      *                          percent of the calibration-time
      *                          (i.e. idle-state) sensor readout value.
-     * @param callback User callback function, which can be any type compatible
-     *                 with a C++ std::function object, i.e. plain global
-     *                 functions, static an non-static class or instance members
-     *                 or C++11 lambda expressions.
+     * @param callback User callback function: a plain global or static member
+     *                 function, or a lambda expression or other function
+     *                 object whose captured state fits into
+     *                 ESP32TOUCH_CALLBACK_CAPTURE_SIZE bytes. Pointers to
+     *                 non-static members are not supported, capture the
+     *                 instance in a lambda instead.
      *                 The callback must have a signature of void(void).
      * @param buttonState The state that the button must be in for the callback 
            *              to be triggered.
@@ -126,15 +516,235 @@ public:
      *                       callback becomes active. This prevents button 
      *                       triggering if a button press causes button 
      *                       behavior to change.
+     * @param release_threshold_percent Touch button release detection
+     *                          threshold in percent of the idle-state sensor
+     *                          readout value, for hysteresis. A pressed
+     *                          button is released only when the readout
+     *                          rises above this. Must be >= threshold_percent,
+     *                          0 (default) uses threshold_percent.
      */
     void configure_input(const int input_number,
                          const uint8_t threshold_percent,
                          CallbackT callback = nullptr,
                          const BUTTON_STATE buttonState = SHORT_PRESSED,
                          const TRIGGER_MODE edgeTrigger = RISE,
-                         const bool waitForRelease = true);
+                         const bool waitForRelease = true,
+                         const uint8_t release_threshold_percent = 0);
+
+    /** @brief Same as above, but with a callback receiving the pad, state,
+     *         edge, press duration, timestamp and filtered readout.
+     * 
+     * One handler can then serve all pads and states, without capturing
+     * the pad number or calling millis(). A callback registered for the
+     * same pad and state with either overload replaces the other one.
+     * 
+     * @param callback User callback with a signature of
+     *                 void(const ESP32Touch::TouchEvent &)
+     */
+    void configure_input(const int input_number,
+                         const uint8_t threshold_percent,
+                         EventCallbackT callback,
+                         const BUTTON_STATE buttonState = SHORT_PRESSED,
+                         const TRIGGER_MODE edgeTrigger = RISE,
+                         const bool waitForRelease = true,
+                         const uint8_t release_threshold_percent = 0);
+
+    /** @brief Same as the first overload without a callback. Resolves
+     *         configure_input(pin, threshold, nullptr, ...), which would
+     *         otherwise be ambiguous between the two callback types.
+     */
+    void configure_input(const int input_number,
+                         const uint8_t threshold_percent,
+                         std::nullptr_t,
+                         const BUTTON_STATE buttonState = SHORT_PRESSED,
+                         const TRIGGER_MODE edgeTrigger = RISE,
+                         const bool waitForRelease = true,
+                         const uint8_t release_threshold_percent = 0) {
+        configure_input(input_number, threshold_percent, CallbackT{}, buttonState,
+                        edgeTrigger, waitForRelease, release_threshold_percent);
+    }
+
+    /** @brief Same as above, but the events are put into the event queue
+     *         instead of calling a callback, see pollEvent().
+     * 
+     * This lets e.g. loop() handle touch events on its own schedule
+     * instead of from the event loop context. The queue holds
+     * ESP32TOUCH_EVENT_QUEUE_SIZE events, further events are dropped
+     * until the application catches up, see getEventQueueDropCount().
+     * Registering a callback for the same pad and state ends queueing.
+     */
+    void configure_queued_input(const int input_number,
+                                const uint8_t threshold_percent,
+                                const BUTTON_STATE buttonState = SHORT_PRESSED,
+                                const TRIGGER_MODE edgeTrigger = RISE,
+                                const bool waitForRelease = true,
+                                const uint8_t release_threshold_percent = 0);
+
+    /** @brief Take the oldest event from the event queue, if any.
+     *         Never blocks. Call from one task only.
+     * @return false if the queue was empty
+     */
+    bool pollEvent(TouchEvent &event);
+
+    /** @brief Wait up to timeout_ms for an event from the event queue.
+     * 
+     * The calling task sleeps on a semaphore which the event loop gives
+     * with every queued event. This needs the event loop to run in
+     * another context, e.g. startDispatcherTask(): a loop() waiting here
+     * would not call updateButtons(). Call from one task only.
+     * 
+     * @param timeout_ms Maximum wait time, 0 to poll,
+     *                   UINT32_MAX to wait forever
+     * @return false on timeout
+     */
+    bool waitEvent(TouchEvent &event, const uint32_t timeout_ms);
+
+    /** @brief Number of events lost because the event queue was full */
+    uint32_t getEventQueueDropCount();
+
+    /** @brief Most events ever waiting in the event queue at once.
+     *         Reaching ESP32TOUCH_EVENT_QUEUE_SIZE means events were or
+     *         nearly were dropped.
+     */
+    uint32_t getEventQueueHighWater();
     
     
+    /** @brief Set the minimum press durations after which a touch pad
+     *         enters the SHORT_PRESSED, MEDIUM_PRESSED and LONG_PRESSED states.
+     * 
+     * This can be called at any time, but deadlines are computed in advance:
+     * a press already in progress keeps its next state step, the new times
+     * apply from the step after that or from the next press.
+     * The defaults are DEFAULT_PRESS_TIMES_MS.
+     * 
+     * @param input_number Touch input pin number
+     * @param short_ms Press time for SHORT_PRESSED
+     * @param medium_ms Press time for MEDIUM_PRESSED, should be >= short_ms
+     * @param long_ms Press time for LONG_PRESSED, should be >= medium_ms
+     */
+    void setPressDurations(const int input_number,
+                           const uint32_t short_ms,
+                           const uint32_t medium_ms,
+                           const uint32_t long_ms);
+
+    /** @brief Register a callback for a double or triple tap on a touch pad.
+     * 
+     * A tap is a press which is released in the SHORT_PRESSED state, i.e.
+     * held for at least the SHORT_PRESSED and less than the MEDIUM_PRESSED
+     * press duration (see setPressDurations()). Taps follow each other
+     * when each starts at most the multi-tap window (see
+     * setMultiTapWindow()) after the release of the previous one.
+     * 
+     * The callback is called as soon as the highest tap count registered
+     * for the pad is reached, or otherwise when the window after the last
+     * tap expires. A press held to MEDIUM_PRESSED ends the sequence.
+     * 
+     * @param input_number Touch input pin number, which must also be
+     *                     configured via configure_input()
+     * @param num_taps Number of taps, 2 .. MAX_TAP_COUNT
+     * @param callback User callback, as for configure_input()
+     * @param suppress_single_tap When set, the SHORT_PRESSED callback of
+     *        the pad is deferred until the window after a single tap has
+     *        expired, and not called at all for multi-taps or holds.
+     *        Applies to all multi-tap callbacks of the pad.
+     */
+    void configure_multi_tap(const int input_number,
+                             const uint8_t num_taps,
+                             CallbackT callback,
+                             const bool suppress_single_tap = false);
+
+    /** @brief Set the multi-tap window of a touch pad in ms.
+     *         The default is DEFAULT_MULTI_TAP_WINDOW_MS.
+     */
+    void setMultiTapWindow(const int input_number, const uint16_t window_ms);
+
+    /** @brief Call a callback repeatedly while a touch pad is held.
+     * 
+     * The first repeat is called delay_ms after the start of the press,
+     * the next one interval_ms later. Each further interval is shorter by
+     * acceleration_percent, down to min_interval_ms. The callback
+     * receives the number of the repeat, starting from 1 for each press.
+     * 
+     * Repeats are scheduled on absolute deadlines. If the event loop
+     * falls behind, overdue repeats are not made up for.
+     * 
+     * @param input_number Touch input pin number, which must also be
+     *                     configured via configure_input()
+     * @param callback User callback, nullptr disables auto-repeat
+     * @param delay_ms Time from the start of the press to the first repeat
+     * @param interval_ms Time between the first and the second repeat
+     * @param min_interval_ms Shortest time between two repeats
+     * @param acceleration_percent Interval reduction per repeat
+     */
+    void configure_auto_repeat(const int input_number,
+                               RepeatCallbackT callback,
+                               const uint16_t delay_ms = DEFAULT_REPEAT_DELAY_MS,
+                               const uint16_t interval_ms = DEFAULT_REPEAT_INTERVAL_MS,
+                               const uint16_t min_interval_ms = DEFAULT_REPEAT_MIN_INTERVAL_MS,
+                               const uint8_t acceleration_percent
+                                   = DEFAULT_REPEAT_ACCELERATION_PERCENT);
+
+    /** @brief Register a callback for a chord, i.e. a combination of touch
+     *         pads pressed together.
+     * 
+     * The chord is recognised when all of its pads are touched and their
+     * presses started at most skew_ms apart. The callback is then called
+     * once, and no other callbacks (press states, taps, other chords) are
+     * called for these pads until each of them is released.
+     * 
+     * So that a chord can still be recognised, the SHORT_PRESSED state
+     * of its pads is entered no earlier than skew_ms after the press.
+     * Chords are matched in registration order, so register a chord before
+     * any other chord which is a subset of it.
+     * 
+     * @param pad_mask Bit n set for touch pad n, at least two pads, which
+     *                 must also be configured via configure_input()
+     * @param callback User callback, as for configure_input()
+     * @param skew_ms Maximum time between the first and the last press
+     * @return false if ESP32TOUCH_MAX_CHORDS chords are already registered
+     *         or pad_mask has less than two pads
+     */
+    bool configure_chord(const uint16_t pad_mask,
+                         CallbackT callback,
+                         const uint16_t skew_ms = DEFAULT_CHORD_SKEW_MS);
+
+    /** @brief Remove all chords registered via configure_chord() */
+    void clearChords();
+
+    /** @brief Configure adjacent touch pads as a slider or wheel.
+     * 
+     * The finger position is interpolated from the normalised signals of
+     * all pads, see TouchSlider. While touched, the callback receives
+     * position and velocity for every filter output sample, i.e. at the
+     * filter rate, from the event loop; once more with touched == false
+     * when the finger is lifted.
+     * 
+     * This enables the pads like configure_input() without a callback.
+     * Pads of a slider should not be used for buttons or other sliders.
+     * Call this before begin().
+     * 
+     * @param pads Touch pad numbers in order, first to last
+     * @param num_pads Number of pads, up to TouchSlider::MAX_PADS,
+     *                 at least two for a slider and three for a wheel
+     * @param callback User callback
+     * @param wheel true if the last pad is adjacent to the first one
+     * @param threshold_percent Slider touched if any of its pads reads
+     *                          below this percentage of its baseline, 1..99
+     * @return false if ESP32TOUCH_MAX_SLIDERS sliders are already
+     *         configured, or the number of pads or the threshold is out
+     *         of range
+     */
+    bool configure_slider(const uint8_t *pads,
+                          const uint8_t num_pads,
+                          SliderCallbackT callback,
+                          const bool wheel = false,
+                          const uint8_t threshold_percent = DEFAULT_SLIDER_THRESHOLD_PERCENT);
+
+    /** @brief Remove all sliders configured via configure_slider().
+     *         Their pads stay enabled until disableButton().
+     */
+    void clearSliders();
+
     /** @brief Force a sensor re-calibration.
      * 
      * This is called implicitly by ESP32Touch::begin(), but can be called
@@ -142,53 +752,403 @@ public:
      * 
      * The touch buttons must not be pressed down while the calibration
      * is running..
+     * 
+     * This uses a single filter output per pad, see startCalibration()
+     * for a non-blocking, multi-sample alternative.
      */
     void calibrate_thresholds();
 
+    /** @brief Start a non-blocking sensor re-calibration.
+     * 
+     * Over the following dispatch cycles, calibration_samples filter
+     * outputs are collected for every enabled pad, after discarding
+     * calibration_settle_samples. Outliers are rejected and baseline and
+     * noise are computed from the remaining samples. The new baselines and
+     * thresholds of all pads then take effect at once, from one filter
+     * period on, and on_complete is called from the dispatcher context.
+     * 
+     * A pad with more than half of its samples rejected keeps its previous
+     * calibration. Buttons continue to work with their previous thresholds
+     * while the calibration is running, but should not be pressed.
+     * 
+     * @param on_complete Called with bit n set for every calibrated pad n
+     * @return false if a calibration is already running
+     */
+    bool startCalibration(CalibrationCallbackT on_complete = nullptr);
+
+    /** @brief true while a startCalibration() run is not yet complete */
+    bool calibrationRunning();
+
+    /** @brief Restore the baseline of a touch pad, e.g. from a value
+     *         persisted after a previous calibration.
+     * 
+     * Call this after configure_input() and before begin(), with
+     * calibrate_on_begin cleared, so that the pad detects presses
+     * right from the start.
+     */
+    void setBaseline(const int input_number, const uint16_t baseline);
+
     /** @brief This must be called once after all the
      *         user callbacks have been set up.
+     * 
+     * This attaches the instance to the touch peripheral filter output
+     * (and interrupt), for up to ESP32TOUCH_MAX_INSTANCES instances at a
+     * time. Instances are independent of each other, but on the hardware
+     * they should use disjoint touch pads.
      */
     void begin();
 
+    /** @brief Like begin(), but without attaching to the touch peripheral
+     *         or starting the event timer, e.g. for replaying recorded
+     *         traces on a host.
+     * 
+     * Samples then only come from feedFilterOutput(), and the event loop
+     * only runs in processQueuedSamples(). Thresholds are set via
+     * setBaseline() or startCalibration(). Interrupt driven mode is not
+     * available.
+     */
+    void beginDetached();
+
+    /** @brief Process one filter output as if it came from the touch
+     *         peripheral, e.g. for simulation or replay on a host.
+     * 
+     * This runs the complete producer side (thresholds, debouncing,
+     * baseline tracking, sample queue) of this instance only, with the
+     * given timestamp instead of the system clock. Together with
+     * processQueuedSamples(), independent instances can be driven from
+     * different threads concurrently.
+     * 
+     * @param filtered_value Filtered sensor readout of all TOUCH_PAD_MAX pads
+     * @param timestamp_ms Sample time
+     * @param raw_value Raw sensor readout of all TOUCH_PAD_MAX pads, only
+     *                  used for trace recording (see startTrace()).
+     *                  nullptr records the filtered readout instead.
+     */
+    void feedFilterOutput(const uint16_t *filtered_value, const uint32_t timestamp_ms,
+                          const uint16_t *raw_value = nullptr);
+
+    /** @brief Record the raw and filtered readout of the enabled touch pads
+     *         for every filter output, e.g. to reproduce problems offline.
+     * 
+     * This restarts the recorder, see TraceRecorder::start(). The filter
+     * callback then only encodes each sample into the recorder's buffer.
+     * Call TraceRecorder::drain() regularly, e.g. from loop(), to write
+     * the trace to Serial or a file; samples are dropped when it is full.
+     * 
+     * @param recorder Must stay valid until stopTrace()
+     */
+    void startTrace(TraceRecorder &recorder);
+
+    /** @brief Stop recording. The recorder may still hold buffered bytes
+     *         to drain.
+     */
+    void stopTrace();
+
+    /** @brief Run one event loop cycle now, independent of the event timer.
+     * @return Number of queued samples processed
+     */
+    int processQueuedSamples();
+
     /** @brief Call this periodicly to see the raw sensor readout values printed
      */
     void diagnostics();
+
+    /** @brief Get the most recent filter output for all touch pads.
+     * 
+     * The returned values are always from one and the same filter period,
+     * even when called concurrently with the filter callback. This never
+     * blocks the filter callback and is safe to call from any context.
+     */
+    Sample getLatestSample();
+
+    /** @brief Current idle-state sensor readout (baseline) of a touch pad,
+     *         from calibration and the adaptive baseline tracking.
+     */
+    uint16_t getBaseline(const int input_number);
+
+    /** @brief Sensor noise (standard deviation) of a touch pad as
+     *         measured by the last startCalibration() run
+     */
+    uint16_t getNoise(const int input_number);
     
 private:
     // The ESP-IDF API threshold is not used in this code
     static constexpr int threshold_inactive = 0;
 
+    // Per-pad state read or written by the filter callback for every sample
+    struct PadSenseState
+    {
+        // Adaptive baseline, only updated for the pads in tracked_mask
+        BaselineTracker baseline;
+        // Press and release thresholds (hysteresis)
+        uint16_t threshold;
+        uint16_t release_threshold;
+        // Start of the approach zone for adaptive dispatch
+        uint16_t approach_threshold;
+        // Samples read opposite to the debounced state, see debouncing_mask
+        uint8_t debounce_count;
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+        // First sample of the current debounce run
+        uint32_t crossing_time_us;
+#endif
+    };
+
+    // Per-pad state of the event loop, only touched for pads with pending work
+    struct PadPressState
+    {
+        uint32_t initial_press_time;
+        // Absolute time (sample timestamp) at which a held pad enters
+        // next_state. Computed at press start and on each state change, so
+        // that a held pad costs only one integer compare per sample.
+        uint32_t next_deadline_ms;
+        // Press time at which state was entered, as scheduled
+        uint32_t state_delay_ms;
+        BUTTON_STATE state;
+        BUTTON_STATE next_state;
+        TRIGGER_MODE trigger_mode;
+        // Consecutive taps so far and the time by which the next one must
+        // have started, for the pads in tap_pending_mask
+        uint8_t tap_count;
+        uint32_t tap_deadline_ms;
+        // Auto-repeat of a held pad in repeat_mask: time of the next
+        // repeat, the interval after it, and the repeats so far
+        uint32_t repeat_deadline_ms;
+        uint16_t repeat_interval_ms;
+        uint16_t repeat_count;
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+        // Raw threshold crossing time of the current press or release
+        uint32_t edge_time_us;
+#endif
+    };
+
+    // Callback of one pad and state: a CallbackT, or an EventCallbackT if
+    // the pad is set in event_mask for that state. Both share the storage,
+    // see setCallback() and clearCallback().
+    union StateCallback
+    {
+        StateCallback() : plain{} {}
+        ~StateCallback() {}
+        CallbackT plain;
+        EventCallbackT event;
+    };
+
+    // Per-pad configuration, read on state changes only
+    struct PadConfig
+    {
+        uint8_t threshold_percent;
+        uint8_t release_percent;
+        uint16_t noise;
+        // Press duration table, indexed by BUTTON_STATE
+        uint32_t press_time_ms[NUM_STATES_DONT_USE];
+        // Indexed by BUTTON_STATE
+        StateCallback callback[NUM_STATES_DONT_USE];
+        // Longest skew of the chords containing this pad, or 0
+        uint16_t chord_skew_ms;
+        // Multi-tap window and callbacks, indexed by number of taps - 2
+        uint16_t tap_window_ms;
+        uint8_t max_taps;
+        CallbackT tap_callback[MAX_TAP_COUNT - 1];
+        // Auto-repeat timing and callback
+        uint16_t repeat_delay_ms;
+        uint16_t repeat_interval_ms;
+        uint16_t repeat_min_interval_ms;
+        uint8_t repeat_acceleration_percent;
+        RepeatCallbackT repeat_callback;
+    };
+
+    struct Chord
+    {
+        uint16_t pad_mask;
+        uint16_t skew_ms;
+        CallbackT callback;
+    };
+
+    struct Slider
+    {
+        TouchSlider engine;
+        SliderCallbackT callback;
+    };
+
+    // Non-blocking calibration, see startCalibration(). The dispatcher
+    // collects samples and publishes the result (READY), the filter
+    // callback applies it between two filter periods (APPLIED), then the
+    // dispatcher calls the completion callback and returns to IDLE.
+    enum CALIBRATION_STATE : uint8_t
+    {
+        CALIBRATION_IDLE,
+        CALIBRATION_COLLECTING,
+        CALIBRATION_READY,
+        CALIBRATION_APPLIED
+    };
+    struct Calibration
+    {
+        std::atomic<uint8_t> state{CALIBRATION_IDLE};
+        uint16_t pad_mask = 0;
+        uint16_t calibrated_mask = 0;
+        uint8_t target = 0;
+        uint8_t skip = 0;
+        uint8_t count = 0;
+        uint16_t result[TOUCH_PAD_MAX] = {};
+        CalibrationCallbackT callback;
+        CalibrationBuffer<ESP32TOUCH_CALIBRATION_MAX_SAMPLES> buffer[TOUCH_PAD_MAX];
+    };
+
+    // Hot state first. Per-pad flags are packed as bit n for touch pad n.
+    uint16_t enabled_mask = 0;
+    // Pads whose callback for a state may fire, indexed by BUTTON_STATE
+    uint16_t active_mask[NUM_STATES_DONT_USE] = {};
+    // Pads which become active with their next release (waitForRelease)
+    uint16_t rearm_mask = 0;
+    // Instantaneous touch state, written by the event loop only
+    std::atomic<uint16_t> pressed_mask{0};
+    // Debounced touch state, written by the filter callback only. Pads in
+    // debouncing_mask have been reading the opposite state for
+    // debounce_count consecutive samples.
+    uint16_t debounced_mask = 0;
+    uint16_t debouncing_mask = 0;
+    // Calibrated pads, whose baseline is tracked
+    uint16_t tracked_mask = 0;
+    // Pads with multi-tap callbacks, with deferred single tap callbacks,
+    // and with a tap sequence in progress
+    uint16_t multi_tap_mask = 0;
+    uint16_t tap_suppress_mask = 0;
+    uint16_t tap_pending_mask = 0;
+    // Pads with an auto-repeat callback
+    uint16_t repeat_mask = 0;
+    // Pads whose events go to the event queue, and pads with a TouchEvent
+    // callback, indexed by BUTTON_STATE
+    uint16_t queued_mask[NUM_STATES_DONT_USE] = {};
+    uint16_t event_mask[NUM_STATES_DONT_USE] = {};
+    // Chords whose pads are all touched, i.e. which have been evaluated
+    // (bit n for chords[n]), and the pads captured by a recognised chord
+    // until their release
+    uint16_t chord_latched_mask = 0;
+    uint16_t chord_captured_mask = 0;
+    uint8_t num_chords = 0;
+    uint8_t num_sliders = 0;
+    uint8_t press_debounce = 1;
+    uint8_t release_debounce = 1;
+    uint8_t baseline_shift = 0;
+    uint8_t approach_percent = DEFAULT_APPROACH_PERCENT;
+    // Event loop period in effect. With adaptive dispatch (active_cycle_ms
+    // not 0), the filter callback sets it to active_cycle_ms and the
+    // dispatcher back to idle_cycle_ms.
+    std::atomic<uint32_t> cycle_ms{dispatch_cycle_time_ms};
+    std::atomic<uint32_t> idle_cycle_ms{0};
+    std::atomic<uint32_t> active_cycle_ms{0};
+    // Interrupt driven mode: the dispatcher is armed, i.e. samples are
+    // queued and processed, while wake_seq != idle_seq. The touch ISR
+    // increments wake_seq, the dispatcher catches up idle_seq when
+    // all buttons are released.
+    std::atomic<bool> interrupt_mode{false};
+    std::atomic<uint32_t> wake_seq{0};
+    std::atomic<uint32_t> idle_seq{0};
+    PadSenseState pad_sense[TOUCH_PAD_MAX];
+    PadPressState pad_press[TOUCH_PAD_MAX];
+    // Filter callback to dispatcher sample queue
+    SpscRing<Sample, ESP32TOUCH_SAMPLE_RING_SIZE> sample_ring;
+    // Dispatcher to application event queue, see configure_queued_input().
+    // The semaphore is given for each event, for waitEvent().
+    SpscRing<TouchEvent, ESP32TOUCH_EVENT_QUEUE_SIZE> event_queue;
+    StaticSemaphore_t event_semaphore_buffer;
+    SemaphoreHandle_t event_semaphore;
+    std::atomic<uint32_t> event_queue_high_water{0};
+    // Latest filter output, published by the filter callback
+    SeqLock<Sample> latest_sample;
+    // Optional recorder fed by the filter callback, see startTrace()
+    std::atomic<TraceRecorder *> trace_recorder{nullptr};
+
+    // Cold state
+    PadConfig pad_config[TOUCH_PAD_MAX];
+    Calibration calibration;
+    Chord chords[ESP32TOUCH_MAX_CHORDS];
+    Slider sliders[ESP32TOUCH_MAX_SLIDERS];
+    CycleCallbackT cycle_callback;
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+    LatencyHistogram pad_latency[TOUCH_PAD_MAX];
+#endif
     // FreeRTOS timer
     Ticker event_timer;
     unsigned long timeOfLastCallback_ms = 0;
-    // Static configuration and runtime state
-    static uint8_t s_pad_threshold_percent[TOUCH_PAD_MAX];
-    static bool s_pad_enabled[TOUCH_PAD_MAX];
-    static bool s_pad_active[TOUCH_PAD_MAX][NUM_STATES_DONT_USE];
-    static uint16_t s_pad_filtered_value[TOUCH_PAD_MAX];
-    static uint16_t s_pad_threshold[TOUCH_PAD_MAX];
-    static CallbackT s_pad_callback[TOUCH_PAD_MAX][NUM_STATES_DONT_USE];
-    static BUTTON_STATE s_pad_state[TOUCH_PAD_MAX];
-    static INSTANTANEOUS_BUTTON_STATE s_pad_instantaneous_state[TOUCH_PAD_MAX];
-    static long s_pad_initial_press_time[TOUCH_PAD_MAX];
-    static TRIGGER_MODE s_pad_trigger_mode[TOUCH_PAD_MAX];
-
-    enum INSTANTANEOUS_BUTTON_STATE getInstantaneousButtonState(const int touch_pin);
-    void updateButtonState(const int touch_pin);
+    // Dispatcher task mode, see startDispatcherTask()
+    std::atomic<TaskHandle_t> dispatcher_task_handle{nullptr};
+    std::atomic<bool> dispatcher_task_running{false};
+    // Stopped task waiting to be deleted, see reapDispatcherTask()
+    std::atomic<TaskHandle_t> dispatcher_task_stopped{nullptr};
+    // Given by the task when it left its loop
+    StaticSemaphore_t dispatcher_task_done_buffer;
+    SemaphoreHandle_t dispatcher_task_done;
+
+    // Instances receiving the touch peripheral filter output and
+    // interrupts, registered by begin()
+    static std::atomic<ESP32Touch *> s_instances[ESP32TOUCH_MAX_INSTANCES];
+    // Filter callbacks and ISRs currently using s_instances. The destructor
+    // waits for this to drop to zero after unregistering.
+    static std::atomic<uint32_t> s_instance_users;
+    static bool s_isr_registered;
+
+    enum INSTANTANEOUS_BUTTON_STATE getInstantaneousButtonState(const int touch_pin,
+                                                                const uint16_t filtered_value,
+                                                                const bool was_touched);
+    uint16_t debounceTouchedMask(const uint16_t touched);
+    bool isEnabled(const int touch_pin) {
+        return enabled_mask & (1u << touch_pin);
+    }
+    void updateButtonState(const int touch_pin, const Sample &sample);
     void initializeButtons();
     void initializeButton(const int touch_pin);
+    void disableMultiTap(const int touch_pin);
+    bool allButtonsReleased();
+    void enableTouchInterrupt();
+    void disableTouchInterrupt();
+    void programHardwareThresholds();
+    void applySettings();
+    void updateThreshold(const int touch_pin);
+    void trackBaselines(const uint16_t *filtered_value, const uint16_t near_mask);
+    void applyCalibration();
+    void collectCalibrationSample(const Sample &sample);
+    void finishCalibration();
+    bool dispatcherArmed();
+    void rearmReleasedPads();
+    bool reapDispatcherTask(const TickType_t wait);
+    void registerInstance();
+    bool unregisterInstance();
 
-    std::map<BUTTON_STATE, float> BUTTON_THRESHOLD_TIMES_MS
-    {
-        {SHORT_PRESSED, 50},
-        {MEDIUM_PRESSED, 300},
-        {LONG_PRESSED, 2000}
-    };
+    void startPressTiming(const int touch_pin, const uint32_t timestamp_ms);
+    void setNextDeadline(const int touch_pin);
+    void recordCallbackLatency(const int touch_pin, const uint32_t nominal_delay_ms);
+    void updateTapState(const int touch_pin, const BUTTON_STATE last_state,
+                        const Sample &sample);
+    void emitTaps(const int touch_pin, const uint32_t nominal_delay_ms,
+                  const Sample &sample);
+    void setCallback(const int touch_pin, const BUTTON_STATE state,
+                     const CallbackT &callback);
+    void setCallback(const int touch_pin, const BUTTON_STATE state,
+                     const EventCallbackT &callback);
+    void clearCallback(const int touch_pin, const BUTTON_STATE state);
+    bool hasCallback(const int touch_pin, const BUTTON_STATE state);
+    void invokeCallback(const int touch_pin, const BUTTON_STATE state,
+                        const TRIGGER_MODE edge, const Sample &sample);
+    void matchChords(const Sample &sample);
+    void updateRepeat(const int touch_pin, const uint32_t timestamp_ms);
 
-    // Filter output reading hook, see ESP-IDF file touch_pad.h
+    // Filter output reading hook, see ESP-IDF file touch_pad.h.
+    // Forwards to handleFilterOutput() of all registered instances.
     static void filter_read_cb(uint16_t *raw_value, uint16_t *filtered_value);
-    // Event loop/handling function
-    void dispatch_callbacks();
+    void handleFilterOutput(const uint16_t *raw_value,
+                            const uint16_t *filtered_value,
+                            const uint32_t timestamp_ms
+#if ESP32TOUCH_LATENCY_HISTOGRAM
+                            , const uint32_t timestamp_us
+#endif
+                            );
+    // Touch hardware threshold ISR for interrupt driven mode
+    static void touch_isr(void *arg);
+    // FreeRTOS task function for the dispatcher task mode
+    static void dispatcher_task(void *arg);
+    // Event loop/handling function, returns number of samples processed
+    int dispatch_callbacks();
+    void dispatch_sample(const Sample &sample);
 }; // class ESP32Touch
 /** @example esp32_touch_example.cpp
  */
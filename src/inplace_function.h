@@ -0,0 +1,155 @@
+/** @file inplace_function.h */
+#ifndef INPLACE_FUNCTION_H
+#define INPLACE_FUNCTION_H
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template<typename Signature, size_t Capacity>
+class InplaceFunction;
+
+/************************ InplaceFunction ************************************//**
+ * @brief Type-erased callable wrapper which never allocates
+ * 
+ * Drop-in replacement for std::function for use in timer and ISR-adjacent
+ * contexts: The callable (function pointer, member function binding or
+ * lambda including its captures) is always stored inside the object.
+ * A callable larger than Capacity bytes is rejected at compile time instead
+ * of silently falling back to the heap.
+ * 
+ * Copying an InplaceFunction copies the stored callable, invoking it does
+ * not copy anything. Wrapping a std::function defeats this: its target
+ * stays on the heap and every copy of the wrapper allocates again.
+ * 
+ * @tparam R Return type
+ * @tparam Args Argument types
+ * @tparam Capacity Inline storage for the callable in bytes
+ */
+template<typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity>
+{
+    template<typename Callable>
+    using Invocable = std::is_convertible<
+        decltype(std::declval<Callable &>()(std::declval<Args>()...)), R>;
+
+    template<typename Callable>
+    using EnableIfCallable = typename std::enable_if<
+        !std::is_same<typename std::decay<Callable>::type, InplaceFunction>::value
+        && (std::is_void<R>::value || Invocable<Callable>::value)>::type;
+
+public:
+    InplaceFunction() noexcept : ops{nullptr} {}
+    InplaceFunction(std::nullptr_t) noexcept : ops{nullptr} {}
+
+    template<typename Callable,
+             typename = decltype(std::declval<Callable &>()(std::declval<Args>()...)),
+             typename = EnableIfCallable<Callable>>
+    InplaceFunction(Callable f) : ops{nullptr} {
+        using Stored = typename std::decay<Callable>::type;
+        static_assert(sizeof(Stored) <= Capacity,
+                      "Callback capture exceeds the inline storage of "
+                      "InplaceFunction, capture less state (e.g. a pointer) "
+                      "or increase the capacity");
+        static_assert(alignof(Stored) <= alignof(Storage),
+                      "Callback capture is over-aligned for InplaceFunction");
+        if (isNull(f)) {
+            return;
+        }
+        new (&storage) Stored(std::move(f));
+        ops = &OpsFor<Stored>::table;
+    }
+
+    InplaceFunction(InplaceFunction &&other) : InplaceFunction(
+            static_cast<const InplaceFunction &>(other)) {}
+
+    InplaceFunction(const InplaceFunction &other) : ops{other.ops} {
+        if (ops) {
+            ops->copy(&storage, &other.storage);
+        }
+    }
+
+    InplaceFunction &operator=(const InplaceFunction &other) {
+        if (this != &other) {
+            reset();
+            if (other.ops) {
+                other.ops->copy(&storage, &other.storage);
+                ops = other.ops;
+            }
+        }
+        return *this;
+    }
+
+    InplaceFunction &operator=(std::nullptr_t) {
+        reset();
+        return *this;
+    }
+
+    ~InplaceFunction() {
+        reset();
+    }
+
+    explicit operator bool() const noexcept {
+        return ops != nullptr;
+    }
+
+    /** @brief Invoke the stored callable in place. Must not be empty. */
+    R operator()(Args... args) const {
+        return ops->invoke(const_cast<Storage *>(&storage),
+                           std::forward<Args>(args)...);
+    }
+
+    static constexpr size_t capacity() {return Capacity;}
+
+private:
+    using Storage = typename std::aligned_storage<
+        Capacity, alignof(std::max_align_t)>::type;
+
+    struct Ops
+    {
+        R (*invoke)(void *callable, Args &&... args);
+        void (*copy)(void *dst, const void *src);
+        void (*destroy)(void *callable);
+    };
+
+    template<typename Callable>
+    struct OpsFor
+    {
+        static R invoke(void *callable, Args &&... args) {
+            return (*static_cast<Callable *>(callable))(std::forward<Args>(args)...);
+        }
+        static void copy(void *dst, const void *src) {
+            new (dst) Callable(*static_cast<const Callable *>(src));
+        }
+        static void destroy(void *callable) {
+            static_cast<Callable *>(callable)->~Callable();
+        }
+        static constexpr Ops table = {invoke, copy, destroy};
+    };
+
+    template<typename Callable>
+    static bool isNull(const Callable &) {return false;}
+    template<typename Callable>
+    static bool isNull(Callable *f) {return f == nullptr;}
+    template<typename S>
+    static bool isNull(const std::function<S> &f) {return !f;}
+
+    void reset() {
+        if (ops) {
+            ops->destroy(&storage);
+            ops = nullptr;
+        }
+    }
+
+    Storage storage;
+    const Ops *ops;
+};
+
+template<typename R, typename... Args, size_t Capacity>
+template<typename Callable>
+constexpr typename InplaceFunction<R(Args...), Capacity>::Ops
+InplaceFunction<R(Args...), Capacity>::OpsFor<Callable>::table;
+
+#endif
@@ -0,0 +1,82 @@
+/** @file latency_histogram.h */
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <stdint.h>
+
+/*********************** LatencyHistogram ************************************//**
+ * @brief Fixed-size log2 histogram of latencies in microseconds
+ * 
+ * Bucket n counts latencies in the range [2^n, 2^(n+1)) us, bucket 0 also
+ * counts zero. Recording is a count-leading-zeros and an increment, without
+ * allocation or locks. Intended for one writer context (the dispatcher);
+ * queries from other contexts see consistent single counters, but not
+ * necessarily one consistent histogram.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int num_buckets = 32;
+
+    /** @brief Record one latency. Single writer context only. */
+    void record(const uint32_t latency_us) {
+        const int bucket = latency_us ? 31 - __builtin_clz(latency_us) : 0;
+        increment(buckets[bucket]);
+        increment(total);
+        if (latency_us > max_us.load(std::memory_order_relaxed)) {
+            max_us.store(latency_us, std::memory_order_relaxed);
+        }
+    }
+
+    /** @brief Upper bound of the bucket holding the given percentile,
+     *         never more than the maximum recorded latency.
+     *         Zero if nothing was recorded.
+     */
+    uint32_t percentile_us(const uint8_t percent) const {
+        const uint32_t n = count();
+        if (n == 0) {
+            return 0;
+        }
+        // Rank of the percentile sample, rounded up, at least 1
+        const uint32_t rank = (static_cast<uint64_t>(n) * percent + 99) / 100;
+        uint32_t seen = 0;
+        for (int i=0; i<num_buckets; ++i) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank && seen > 0) {
+                const uint32_t upper = i == 31 ? UINT32_MAX : (2u << i) - 1;
+                const uint32_t max = max_us.load(std::memory_order_relaxed);
+                return upper < max ? upper : max;
+            }
+        }
+        return max_us.load(std::memory_order_relaxed);
+    }
+
+    uint32_t max() const {return max_us.load(std::memory_order_relaxed);}
+    uint32_t count() const {return total.load(std::memory_order_relaxed);}
+    uint32_t bucket(const int n) const {
+        return buckets[n].load(std::memory_order_relaxed);
+    }
+
+    /** @brief Clear all counts. Only when the writer is not running. */
+    void reset() {
+        for (int i=0; i<num_buckets; ++i) {
+            buckets[i].store(0, std::memory_order_relaxed);
+        }
+        total.store(0, std::memory_order_relaxed);
+        max_us.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // Single writer: no read-modify-write atomics needed
+    static void increment(std::atomic<uint32_t> &counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+    }
+
+    std::atomic<uint32_t> buckets[num_buckets] = {};
+    std::atomic<uint32_t> total{0};
+    std::atomic<uint32_t> max_us{0};
+};
+
+#endif
@@ -0,0 +1,78 @@
+/** @file seqlock.h */
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+/**************************** SeqLock ****************************************//**
+ * @brief Sequence lock protecting a small trivially copyable value
+ * 
+ * One writer context (e.g. the touch filter callback) publishes complete
+ * values with store(), which never blocks and never waits for readers.
+ * Any number of reader contexts get a consistent copy with load(), i.e.
+ * never a mix of two stores. A reader only repeats its copy in the rare
+ * case that a store() was in progress at the same time.
+ * 
+ * The payload is kept in relaxed atomic words, so the concurrent accesses
+ * are well-defined for the compiler and free of locks on the ESP32.
+ */
+template<typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SeqLock payload must be trivially copyable");
+public:
+    SeqLock() {
+        for (size_t i=0; i<num_words; ++i) {
+            words[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /** @brief Publish a new value. Single writer context only. */
+    void store(const T &value) {
+        uint32_t buffer[num_words] = {};
+        memcpy(buffer, &value, sizeof(T));
+        const uint32_t seq = sequence.load(std::memory_order_relaxed);
+        // Odd sequence number marks a store in progress
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i=0; i<num_words; ++i) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /** @brief Get a consistent copy of the last published value */
+    T load() const {
+        uint32_t buffer[num_words];
+        uint32_t seq_before;
+        uint32_t seq_after;
+        do {
+            seq_before = sequence.load(std::memory_order_acquire);
+            for (size_t i=0; i<num_words; ++i) {
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            seq_after = sequence.load(std::memory_order_relaxed);
+        } while ((seq_before & 1) || seq_before != seq_after);
+        T value;
+        memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+
+    /** @brief Number of completed stores, e.g. for change detection */
+    uint32_t version() const {
+        return sequence.load(std::memory_order_acquire) >> 1;
+    }
+
+private:
+    static constexpr size_t num_words = (sizeof(T) + 3) / 4;
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint32_t> words[num_words];
+};
+
+#endif
@@ -0,0 +1,80 @@
+/** @file spsc_ring.h */
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/************************** SpscRing *****************************************//**
+ * @brief Fixed-size, allocation-free single-producer/single-consumer ring
+ * 
+ * push() may only be called from one context (e.g. the touch filter
+ * callback) and pop() only from one other context (e.g. the dispatcher).
+ * Neither side ever blocks or takes a lock. When the ring is full, push()
+ * drops the new element and increments the overrun counter, so the
+ * consumer always sees an unbroken sequence of the oldest elements.
+ * 
+ * @tparam T Element type, copied in and out by value
+ * @tparam N Capacity, must be a power of two
+ */
+template<typename T, size_t N>
+class SpscRing
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0,
+                  "SpscRing capacity must be a power of two");
+public:
+    /** @brief Append an element. Producer side only.
+     * @return false if the ring was full and the element was dropped
+     */
+    bool push(const T &item) {
+        const uint32_t head = write_index.load(std::memory_order_relaxed);
+        if (head - read_index.load(std::memory_order_acquire) >= N) {
+            overrun_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        buffer[head & (N - 1)] = item;
+        write_index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Remove the oldest element. Consumer side only.
+     * @return false if the ring was empty
+     */
+    bool pop(T &item) {
+        const uint32_t tail = read_index.load(std::memory_order_relaxed);
+        if (tail == write_index.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = buffer[tail & (N - 1)];
+        read_index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Discard all queued elements. Consumer side only. */
+    void clear() {
+        read_index.store(write_index.load(std::memory_order_acquire),
+                         std::memory_order_release);
+    }
+
+    /** @brief Number of queued elements (a snapshot when called concurrently) */
+    size_t size() const {
+        return write_index.load(std::memory_order_acquire)
+               - read_index.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() {return N;}
+
+    /** @brief Number of elements dropped because the ring was full */
+    uint32_t overruns() const {
+        return overrun_count.load(std::memory_order_relaxed);
+    }
+
+private:
+    T buffer[N];
+    std::atomic<uint32_t> write_index{0};
+    std::atomic<uint32_t> read_index{0};
+    std::atomic<uint32_t> overrun_count{0};
+};
+
+#endif
@@ -0,0 +1,244 @@
+#include <Arduino.h>
+#include <freertos/task.h>
+#include "touch_log.h"
+
+namespace
+{
+
+constexpr uint32_t ring_size = ESP32TOUCH_LOG_RING_SIZE;
+static_assert(ring_size >= 2 && (ring_size & (ring_size - 1)) == 0,
+              "ESP32TOUCH_LOG_RING_SIZE must be a power of two");
+
+constexpr int count_args(const char *format) {
+    return *format == '\0' ? 0 : (*format == '%') + count_args(format + 1);
+}
+
+#define ESP32TOUCH_LOG_CHECK_ARGS(name, level, format) \
+    static_assert(count_args(format) <= TouchLog::MAX_ARGS, \
+                  "Too many arguments for log message " #name);
+ESP32TOUCH_LOG_MESSAGES(ESP32TOUCH_LOG_CHECK_ARGS)
+#undef ESP32TOUCH_LOG_CHECK_ARGS
+
+const char *const formats[] = {
+#define ESP32TOUCH_LOG_FORMAT(name, level, format) format,
+    ESP32TOUCH_LOG_MESSAGES(ESP32TOUCH_LOG_FORMAT)
+#undef ESP32TOUCH_LOG_FORMAT
+};
+
+const uint8_t num_args[] = {
+#define ESP32TOUCH_LOG_NUM_ARGS(name, level, format) count_args(format),
+    ESP32TOUCH_LOG_MESSAGES(ESP32TOUCH_LOG_NUM_ARGS)
+#undef ESP32TOUCH_LOG_NUM_ARGS
+};
+
+// Bounded multi-producer ring (D. Vyukov). A slot may be written when its
+// sequence number equals the write position, and read when it equals the
+// read position + 1. Producers claim a position by compare-exchange and
+// never wait for each other.
+struct Slot
+{
+    std::atomic<uint32_t> sequence;
+    TouchLog::Record record;
+};
+
+struct Ring
+{
+    Ring() {
+        for (uint32_t n=0; n<ring_size; ++n) {
+            slot[n].sequence.store(n, std::memory_order_relaxed);
+        }
+    }
+    Slot slot[ring_size];
+    std::atomic<uint32_t> write_index{0};
+    // Consumer only
+    uint32_t read_index = 0;
+    std::atomic<uint32_t> dropped{0};
+};
+
+Ring ring;
+
+struct FlushTaskArgs
+{
+    Print *out;
+    bool binary;
+    uint32_t period_ms;
+};
+FlushTaskArgs flush_task_args;
+
+void flush_task(void *arg)
+{
+    const FlushTaskArgs &args = *static_cast<FlushTaskArgs *>(arg);
+    TickType_t last_wake = xTaskGetTickCount();
+    for (;;) {
+        TouchLog::flush(*args.out, args.binary);
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(args.period_ms));
+    }
+}
+
+void put_u32(uint8_t *buffer, const uint32_t value)
+{
+    for (int n=0; n<4; ++n) {
+        buffer[n] = static_cast<uint8_t>(value >> (8 * n));
+    }
+}
+
+uint32_t get_u32(const uint8_t *buffer)
+{
+    uint32_t value = 0;
+    for (int n=0; n<4; ++n) {
+        value |= static_cast<uint32_t>(buffer[n]) << (8 * n);
+    }
+    return value;
+}
+
+} // anonymous namespace
+
+void TouchLog::write(const Id id, const uint32_t arg0,
+                     const uint32_t arg1, const uint32_t arg2)
+{
+    uint32_t position = ring.write_index.load(std::memory_order_relaxed);
+    Slot *slot;
+    for (;;) {
+        slot = &ring.slot[position & (ring_size - 1)];
+        const int32_t diff = static_cast<int32_t>(
+                slot->sequence.load(std::memory_order_acquire) - position);
+        if (diff == 0) {
+            if (ring.write_index.compare_exchange_weak(position, position + 1,
+                                                       std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Full, i.e. not yet read one round ago
+            ring.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            position = ring.write_index.load(std::memory_order_relaxed);
+        }
+    }
+    Record &record = slot->record;
+    record.timestamp_ms = millis();
+    record.id = id;
+    record.arg[0] = arg0;
+    record.arg[1] = arg1;
+    record.arg[2] = arg2;
+    slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+bool TouchLog::pop(Record &record)
+{
+    Slot &slot = ring.slot[ring.read_index & (ring_size - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != ring.read_index + 1) {
+        // Empty, or the oldest record is still being written
+        return false;
+    }
+    record = slot.record;
+    slot.sequence.store(ring.read_index + ring_size, std::memory_order_release);
+    ++ring.read_index;
+    return true;
+}
+
+size_t TouchLog::flush(Print &out, const bool binary)
+{
+    size_t count = 0;
+    Record record;
+    while (pop(record)) {
+        if (binary) {
+            uint8_t buffer[MAX_ENCODED_SIZE];
+            out.write(buffer, encode(record, buffer));
+        } else {
+            format(out, record);
+        }
+        ++count;
+    }
+    return count;
+}
+
+void TouchLog::format(Print &out, const Record &record)
+{
+    out.print(static_cast<unsigned long>(record.timestamp_ms));
+    out.print(" ms: ");
+    if (record.id >= NUM_MESSAGES) {
+        out.print("Unknown log message ");
+        out.println(static_cast<unsigned int>(record.id));
+        return;
+    }
+    int n = 0;
+    for (const char *c=formats[record.id]; *c; ++c) {
+        if (*c != '%' || n >= MAX_ARGS) {
+            out.print(*c);
+            continue;
+        }
+        const uint32_t value = record.arg[n++];
+        switch (*++c) {
+        case 'd':
+            out.print(static_cast<long>(static_cast<int32_t>(value)));
+            break;
+        case 'x':
+            out.print(static_cast<unsigned long>(value), HEX);
+            break;
+        case '\0':
+            --c;
+            break;
+        default:
+            out.print(static_cast<unsigned long>(value));
+            break;
+        }
+    }
+    out.println();
+}
+
+size_t TouchLog::encode(const Record &record, uint8_t *buffer)
+{
+    buffer[0] = SYNC_BYTE;
+    buffer[1] = record.id;
+    put_u32(buffer + 2, record.timestamp_ms);
+    const int args = numArgs(record.id) > 0 ? numArgs(record.id) : 0;
+    for (int n=0; n<args; ++n) {
+        put_u32(buffer + 6 + 4 * n, record.arg[n]);
+    }
+    return 6 + 4 * args;
+}
+
+size_t TouchLog::decode(const uint8_t *buffer, const size_t size, Record &record)
+{
+    if (size < 2) {
+        return 0;
+    }
+    const int args = numArgs(buffer[1]);
+    if (buffer[0] != SYNC_BYTE || args < 0) {
+        return 1;
+    }
+    const size_t length = 6 + 4 * args;
+    if (size < length) {
+        return 0;
+    }
+    record = {};
+    record.id = buffer[1];
+    record.timestamp_ms = get_u32(buffer + 2);
+    for (int n=0; n<args; ++n) {
+        record.arg[n] = get_u32(buffer + 6 + 4 * n);
+    }
+    return length;
+}
+
+int TouchLog::numArgs(const uint8_t id)
+{
+    return id < NUM_MESSAGES ? num_args[id] : -1;
+}
+
+uint32_t TouchLog::dropped()
+{
+    return ring.dropped.load(std::memory_order_relaxed);
+}
+
+bool TouchLog::startFlushTask(Print &out,
+                              const bool binary,
+                              const uint32_t period_ms,
+                              const UBaseType_t priority,
+                              const uint32_t stack_size)
+{
+    flush_task_args = {&out, binary, period_ms};
+    return xTaskCreatePinnedToCore(flush_task, "TouchLog", stack_size,
+                                   &flush_task_args, priority, nullptr,
+                                   tskNO_AFFINITY) == pdPASS;
+}
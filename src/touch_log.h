@@ -0,0 +1,144 @@
+/** @file touch_log.h */
+#ifndef TOUCH_LOG_H
+#define TOUCH_LOG_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <HardwareSerial.h>
+#include <freertos/FreeRTOS.h>
+#include "touch_log_messages.h"
+
+#define ESP32TOUCH_LOG_LEVEL_NONE 0
+#define ESP32TOUCH_LOG_LEVEL_ERROR 1
+#define ESP32TOUCH_LOG_LEVEL_INFO 2
+#define ESP32TOUCH_LOG_LEVEL_DEBUG 3
+
+/** @brief Messages above this level compile to nothing,
+ *         e.g. -DESP32TOUCH_LOG_LEVEL=ESP32TOUCH_LOG_LEVEL_DEBUG
+ */
+#ifndef ESP32TOUCH_LOG_LEVEL
+#define ESP32TOUCH_LOG_LEVEL ESP32TOUCH_LOG_LEVEL_ERROR
+#endif
+
+/** @brief Number of log records buffered until TouchLog::flush().
+ *         Must be a power of two. Costs 24 bytes of RAM per record.
+ */
+#ifndef ESP32TOUCH_LOG_RING_SIZE
+#define ESP32TOUCH_LOG_RING_SIZE 32
+#endif
+
+/** @brief Log a message of touch_log_messages.h, with up to
+ *         TouchLog::MAX_ARGS integer arguments, e.g.
+ *         touch_log(UNSUPPORTED_TAP_COUNT, num_taps);
+ */
+#define touch_log(name, ...) do { \
+        if (TouchLog::LEVEL_##name <= ESP32TOUCH_LOG_LEVEL) { \
+            TouchLog::write(TouchLog::name, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+/*************************** TouchLog ****************************************//**
+ * @brief Deferred binary logger
+ *
+ * touch_log() does not format anything. It stores the message id, a
+ * millisecond timestamp and the integer arguments as one fixed-size record
+ * in a lock-free ring buffer, which takes a few dozen CPU cycles and never
+ * blocks. So it can be used in the event loop and in the filter callback.
+ * When the ring is full, new records are dropped and counted.
+ *
+ * The records are written out later by flush(), either as text or in a
+ * compact binary form (one sync byte, the message id, the timestamp and
+ * the arguments, all little-endian) for decoding on the host, see
+ * host/tools/touch_log_decode.cpp. Call flush() e.g. from loop(), or let
+ * startFlushTask() do it from a low-priority FreeRTOS task.
+ *
+ * Any number of contexts may log at the same time. flush() must only be
+ * called from one context at a time.
+ */
+class TouchLog
+{
+public:
+    enum Id : uint8_t
+    {
+#define ESP32TOUCH_LOG_ID(name, level, format) name,
+        ESP32TOUCH_LOG_MESSAGES(ESP32TOUCH_LOG_ID)
+#undef ESP32TOUCH_LOG_ID
+        NUM_MESSAGES
+    };
+
+    enum Level
+    {
+#define ESP32TOUCH_LOG_LEVEL_OF(name, level, format) \
+        LEVEL_##name = ESP32TOUCH_LOG_LEVEL_##level,
+        ESP32TOUCH_LOG_MESSAGES(ESP32TOUCH_LOG_LEVEL_OF)
+#undef ESP32TOUCH_LOG_LEVEL_OF
+    };
+
+    static constexpr int MAX_ARGS = 3;
+    /** @brief First byte of each record in the binary output */
+    static constexpr uint8_t SYNC_BYTE = 0xA5;
+    /** @brief Longest binary record in bytes */
+    static constexpr size_t MAX_ENCODED_SIZE = 2 + 4 + 4 * MAX_ARGS;
+
+    struct Record
+    {
+        uint32_t timestamp_ms;
+        uint32_t arg[MAX_ARGS];
+        uint8_t id;
+    };
+
+    /** @brief Append a record. Use the touch_log() macro instead. */
+    static void write(const Id id, const uint32_t arg0 = 0,
+                      const uint32_t arg1 = 0, const uint32_t arg2 = 0);
+
+    /** @brief Remove the oldest record
+     * @return false if there is none
+     */
+    static bool pop(Record &record);
+
+    /** @brief Write out and remove all buffered records
+     * @param out Output, e.g. Serial
+     * @param binary true for binary records, false for one line of text
+     *               per record
+     * @return Number of records written
+     */
+    static size_t flush(Print &out, const bool binary = false);
+
+    /** @brief Write one record as a line of text */
+    static void format(Print &out, const Record &record);
+
+    /** @brief Binary form of a record, see flush()
+     * @param buffer At least MAX_ENCODED_SIZE bytes
+     * @return Number of bytes written
+     */
+    static size_t encode(const Record &record, uint8_t *buffer);
+
+    /** @brief Parse one binary record from the start of a buffer
+     * @return Number of bytes consumed: 0 if the buffer holds less than a
+     *         complete record; 1 if it does not start with a valid record,
+     *         in which case the caller should skip one byte to resync
+     */
+    static size_t decode(const uint8_t *buffer, const size_t size, Record &record);
+
+    /** @brief Number of arguments of a message, or -1 for an unknown id */
+    static int numArgs(const uint8_t id);
+
+    /** @brief Records dropped because the ring was full */
+    static uint32_t dropped();
+
+    /** @brief Call flush() every period_ms from a FreeRTOS task
+     * @param out Output, must stay valid while the task runs
+     * @param binary See flush()
+     * @param priority FreeRTOS task priority, lower than that of the
+     *                 touch event loop
+     * @return true if the task is running
+     */
+    static bool startFlushTask(Print &out,
+                               const bool binary = false,
+                               const uint32_t period_ms = 100,
+                               const UBaseType_t priority = 1,
+                               const uint32_t stack_size = 2048);
+};
+
+#endif
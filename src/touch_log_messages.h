@@ -0,0 +1,29 @@
+/** @file touch_log_messages.h
+ * @brief Message table of the deferred binary logger, see touch_log.h
+ *
+ * One X(name, level, format) entry per message. The position in this
+ * table is the message id in the binary records, so append new messages
+ * at the end and keep the firmware and the host decoder in sync.
+ *
+ * Formats take up to TouchLog::MAX_ARGS placeholders:
+ * %u unsigned, %d signed, %x hexadecimal.
+ */
+#define ESP32TOUCH_LOG_MESSAGES(X) \
+    X(DISPATCHER_TASK_FAILED, ERROR, "Could not create the touch dispatcher task") \
+    X(REGISTER_CALLBACK, DEBUG, "Registering callback for touch button no.: %u") \
+    X(UNSUPPORTED_TAP_COUNT, ERROR, "Unsupported number of taps: %u") \
+    X(CHORD_NOT_REGISTERED, ERROR, "Chord not registered: 0x%x") \
+    X(TOO_MANY_SLIDERS, ERROR, "Slider not configured, too many sliders") \
+    X(UNSUPPORTED_SLIDER_PADS, ERROR, "Slider not configured, unsupported number of pads: %u") \
+    X(CALIBRATE_INPUT, DEBUG, "Touch input %u readout: %u threshold: %u") \
+    X(CALIBRATED_INPUT, DEBUG, "Calibrated touch input %u baseline: %u noise: %u") \
+    X(CALIBRATION_OUTLIERS, ERROR, "Too many outliers, calibration failed for touch input no.: %u") \
+    X(TOO_MANY_INSTANCES, ERROR, "Too many ESP32Touch instances, see ESP32TOUCH_MAX_INSTANCES") \
+    X(PRESS_TIME, DEBUG, "Touch input %u held for %u ms") \
+    X(RISING_CALLBACK, DEBUG, "Dispatching rising callback for touch input no.: %u") \
+    X(FALLING_CALLBACK, DEBUG, "Dispatching falling callback for touch input no.: %u") \
+    X(REPEAT_CALLBACK, DEBUG, "Dispatching repeat callback for touch input no.: %u repeat: %u") \
+    X(CHORD_CALLBACK, DEBUG, "Dispatching chord callback for touch inputs: 0x%x") \
+    X(TAP_CALLBACK, DEBUG, "Dispatching tap callback for touch input no.: %u taps: %u") \
+    X(EVENT_QUEUE_FULL, INFO, "Event queue full, dropped event of touch input no.: %u") \
+    X(INVALID_SLIDER_THRESHOLD, ERROR, "Slider not configured, threshold out of range: %u percent")
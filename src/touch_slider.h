@@ -0,0 +1,179 @@
+/** @file touch_slider.h */
+#ifndef TOUCH_SLIDER_H
+#define TOUCH_SLIDER_H
+
+#include <stdint.h>
+
+/************************** TouchSlider **************************************//**
+ * @brief Integer-only position and velocity of a finger on a row (slider)
+ *        or ring (wheel) of adjacent touch pads
+ *
+ * Each pad signal is normalised as the relative drop of its filtered
+ * readout below its baseline, in units of 1/1024 of the baseline, so that
+ * pads of different size and parasitic capacitance compare equally.
+ * The position is then the centroid of the strongest pad and its two
+ * neighbours, in units of 1/PAD_PITCH of the pad distance:
+ *
+ *     position = peak * PAD_PITCH
+ *                + PAD_PITCH * (next - previous) / (previous + peak + next)
+ *
+ * For a slider, the range is 0 (first pad) to (num_pads - 1) * PAD_PITCH
+ * (last pad). For a wheel, the last pad neighbours the first one and the
+ * position wraps around from num_pads * PAD_PITCH - 1 to 0.
+ *
+ * The velocity is the position change per second, smoothed over about
+ * four samples, and zero for the first sample of a touch.
+ * For a wheel, it takes the shorter way around.
+ */
+class TouchSlider
+{
+public:
+    /** @brief Maximum number of pads of one slider or wheel */
+    static constexpr int MAX_PADS = 10;
+    /** @brief Position units between two adjacent pads */
+    static constexpr int32_t PAD_PITCH = 256;
+
+    /** @brief Position update, see ESP32Touch::configure_slider() */
+    struct State
+    {
+        uint32_t timestamp_ms;
+        /** @brief Finger position, valid if touched */
+        uint16_t position;
+        /** @brief Position units per second, positive towards the last pad */
+        int32_t velocity;
+        /** @brief false for the first sample after the finger was lifted */
+        bool touched;
+    };
+
+    /** @brief Set the ordered pad list
+     * @param pads Touch pad numbers, first to last
+     * @param num_pads Number of pads, 2..MAX_PADS (3..MAX_PADS for a wheel)
+     * @param wheel true if the last pad neighbours the first one
+     * @param threshold_percent Touched if the readout of any pad is below
+     *        this percentage of its baseline, 1..99
+     * @return false if the number of pads or the threshold is out of range
+     */
+    bool configure(const uint8_t *pads, const uint8_t num_pads,
+                   const bool wheel, const uint8_t threshold_percent) {
+        if (num_pads < (wheel ? 3 : 2) || num_pads > MAX_PADS) {
+            return false;
+        }
+        // 100 and above would count an idle panel as touched
+        if (threshold_percent < 1 || threshold_percent > 99) {
+            return false;
+        }
+        for (int n=0; n<num_pads; ++n) {
+            pad[n] = pads[n];
+        }
+        count = num_pads;
+        is_wheel = wheel;
+        touch_level = (100u - threshold_percent) * 1024u / 100u;
+        state = {};
+        return true;
+    }
+
+    /** @brief Bit n set for each touch pad n of this slider */
+    uint16_t padMask() const {
+        uint16_t mask = 0;
+        for (int n=0; n<count; ++n) {
+            mask |= 1u << pad[n];
+        }
+        return mask;
+    }
+
+    /** @brief Feed one filter output sample
+     * @param filtered_value Filtered readouts, indexed by touch pad number
+     * @param baseline Idle-state readouts, indexed by touch pad number
+     * @return true if the state changed, i.e. for every sample while
+     *         touched and for the first one after the finger was lifted
+     */
+    bool update(const uint16_t *filtered_value, const uint16_t *baseline,
+                const uint32_t timestamp_ms) {
+        uint16_t level[MAX_PADS] = {};
+        int peak = 0;
+        for (int n=0; n<count; ++n) {
+            const uint16_t base = baseline[pad[n]];
+            const uint16_t value = filtered_value[pad[n]];
+            level[n] = base > value
+                       ? (static_cast<uint32_t>(base - value) << 10) / base : 0;
+            if (level[n] > level[peak]) {
+                peak = n;
+            }
+        }
+        if (level[peak] < touch_level) {
+            if (!state.touched) {
+                return false;
+            }
+            state.touched = false;
+            state.velocity = 0;
+            state.timestamp_ms = timestamp_ms;
+            return true;
+        }
+
+        const int32_t position = interpolate(level, peak);
+        if (state.touched) {
+            const uint32_t dt_ms = timestamp_ms - state.timestamp_ms;
+            if (dt_ms) {
+                const int32_t raw = distance(state.position, position) * 1000
+                                    / static_cast<int32_t>(dt_ms);
+                state.velocity += (raw - state.velocity) / 4;
+            }
+        } else {
+            state.velocity = 0;
+        }
+        state.position = static_cast<uint16_t>(position);
+        state.touched = true;
+        state.timestamp_ms = timestamp_ms;
+        return true;
+    }
+
+    const State &current() const {
+        return state;
+    }
+
+private:
+    uint8_t pad[MAX_PADS];
+    uint8_t count = 0;
+    bool is_wheel = false;
+    uint16_t touch_level = 0;
+    State state = {};
+
+    int32_t interpolate(const uint16_t *level, const int peak) const {
+        const int last = count - 1;
+        int32_t previous = 0;
+        int32_t next = 0;
+        if (peak > 0 || is_wheel) {
+            previous = level[peak > 0 ? peak - 1 : last];
+        }
+        if (peak < last || is_wheel) {
+            next = level[peak < last ? peak + 1 : 0];
+        }
+        const int32_t sum = previous + level[peak] + next;
+        int32_t position = peak * PAD_PITCH + PAD_PITCH * (next - previous) / sum;
+        if (is_wheel) {
+            const int32_t range = count * PAD_PITCH;
+            position = (position + range) % range;
+        } else if (position < 0) {
+            position = 0;
+        } else if (position > last * PAD_PITCH) {
+            position = last * PAD_PITCH;
+        }
+        return position;
+    }
+
+    // Signed position change, the shorter way around for a wheel
+    int32_t distance(const int32_t from, const int32_t to) const {
+        int32_t d = to - from;
+        if (is_wheel) {
+            const int32_t range = count * PAD_PITCH;
+            if (d >= range / 2) {
+                d -= range;
+            } else if (d < -range / 2) {
+                d += range;
+            }
+        }
+        return d;
+    }
+};
+
+#endif
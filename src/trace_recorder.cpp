@@ -0,0 +1,237 @@
+#include <string.h>
+#include "trace_recorder.h"
+
+namespace
+{
+
+const uint8_t magic[4] = {'E', 'T', 'R', '1'};
+
+inline uint8_t *put_varint(uint8_t *out, uint32_t value)
+{
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+inline uint8_t *put_delta(uint8_t *out, const uint16_t value, const uint16_t last)
+{
+    const int32_t delta = static_cast<int32_t>(value) - last;
+    // Zigzag: small differences of either sign encode to small numbers
+    return put_varint(out, (static_cast<uint32_t>(delta) << 1)
+                           ^ static_cast<uint32_t>(delta >> 31));
+}
+
+} // anonymous namespace
+
+//////// TraceRecorder
+
+void TraceRecorder::start(const uint16_t pad_mask)
+{
+    this->pad_mask = pad_mask;
+    key_pending = true;
+    dropped_since_key = 0;
+    total_dropped.store(0, std::memory_order_relaxed);
+    read_index.store(0, std::memory_order_relaxed);
+    write_index.store(0, std::memory_order_relaxed);
+    write(magic, sizeof(magic));
+}
+
+bool TraceRecorder::record(const uint16_t *raw_value, const uint16_t *filtered_value,
+                           const uint32_t timestamp_ms)
+{
+    uint8_t frame[MAX_FRAME_SIZE];
+    uint8_t *out = frame;
+    uint16_t pads = pad_mask;
+    if (key_pending) {
+        *out++ = KEY_FRAME;
+        *out++ = static_cast<uint8_t>(pad_mask);
+        *out++ = static_cast<uint8_t>(pad_mask >> 8);
+        for (int n=0; n<4; ++n) {
+            *out++ = static_cast<uint8_t>(timestamp_ms >> (8 * n));
+        }
+        out = put_varint(out, dropped_since_key);
+        while (pads) {
+            const int i = __builtin_ctz(pads);
+            pads &= pads - 1;
+            out = put_varint(out, raw_value[i]);
+            out = put_varint(out, filtered_value[i]);
+        }
+    } else {
+        *out++ = DELTA_FRAME;
+        out = put_varint(out, timestamp_ms - last_timestamp_ms);
+        while (pads) {
+            const int i = __builtin_ctz(pads);
+            pads &= pads - 1;
+            out = put_delta(out, raw_value[i], last_raw[i]);
+            out = put_delta(out, filtered_value[i], last_filtered[i]);
+        }
+    }
+    if (!write(frame, out - frame)) {
+        // The next frame must not refer to this one
+        key_pending = true;
+        ++dropped_since_key;
+        total_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    key_pending = false;
+    dropped_since_key = 0;
+    last_timestamp_ms = timestamp_ms;
+    pads = pad_mask;
+    while (pads) {
+        const int i = __builtin_ctz(pads);
+        pads &= pads - 1;
+        last_raw[i] = raw_value[i];
+        last_filtered[i] = filtered_value[i];
+    }
+    return true;
+}
+
+size_t TraceRecorder::drain(Print &out)
+{
+    const uint32_t head = write_index.load(std::memory_order_acquire);
+    const uint32_t tail = read_index.load(std::memory_order_relaxed);
+    const size_t size = head - tail;
+    const uint32_t start = tail & (buffer_size - 1);
+    // In two parts if wrapped around the end of the buffer
+    const size_t first = size < buffer_size - start ? size : buffer_size - start;
+    out.write(buffer + start, first);
+    out.write(buffer, size - first);
+    read_index.store(head, std::memory_order_release);
+    return size;
+}
+
+bool TraceRecorder::write(const uint8_t *data, const size_t size)
+{
+    const uint32_t head = write_index.load(std::memory_order_relaxed);
+    if (buffer_size - (head - read_index.load(std::memory_order_acquire)) < size) {
+        return false;
+    }
+    const uint32_t start = head & (buffer_size - 1);
+    const size_t first = size < buffer_size - start ? size : buffer_size - start;
+    memcpy(buffer + start, data, first);
+    memcpy(buffer, data + first, size - first);
+    write_index.store(head + size, std::memory_order_release);
+    return true;
+}
+
+//////// TraceReader
+
+TraceReader::TraceReader(const uint8_t *data, const size_t size)
+    : data{data}, size{size}
+{
+    if (size >= sizeof(magic) && memcmp(data, magic, sizeof(magic)) == 0) {
+        pos = sizeof(magic);
+    }
+}
+
+bool TraceReader::next(Frame &frame)
+{
+    while (pos < size) {
+        if (!synced && data[pos] != TraceRecorder::KEY_FRAME) {
+            ++pos;
+            continue;
+        }
+        const size_t frame_start = pos;
+        if (decodeFrame(frame)) {
+            synced = true;
+            last = frame;
+            return true;
+        }
+        if (pos >= size) {
+            // Truncated at the end of the stream
+            return false;
+        }
+        // Not a valid frame, resync on the next key frame
+        synced = false;
+        pos = frame_start + 1;
+    }
+    return false;
+}
+
+bool TraceReader::readVarint(uint32_t &value)
+{
+    value = 0;
+    for (int shift=0; shift<35; shift+=7) {
+        if (pos >= size) {
+            return false;
+        }
+        const uint8_t byte = data[pos++];
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TraceReader::readFixed(uint32_t &value, const int bytes)
+{
+    if (size - pos < static_cast<size_t>(bytes)) {
+        pos = size;
+        return false;
+    }
+    value = 0;
+    for (int n=0; n<bytes; ++n) {
+        value |= static_cast<uint32_t>(data[pos++]) << (8 * n);
+    }
+    return true;
+}
+
+bool TraceReader::decodeFrame(Frame &frame)
+{
+    const uint8_t tag = data[pos++];
+    uint32_t value;
+    if (tag == TraceRecorder::KEY_FRAME) {
+        frame = {};
+        if (!readFixed(value, 2)) {
+            return false;
+        }
+        frame.pad_mask = static_cast<uint16_t>(value);
+        if (frame.pad_mask >> TOUCH_PAD_MAX) {
+            return false;
+        }
+        if (!readFixed(frame.timestamp_ms, 4) || !readVarint(frame.dropped_before)) {
+            return false;
+        }
+        uint16_t pads = frame.pad_mask;
+        while (pads) {
+            const int i = __builtin_ctz(pads);
+            pads &= pads - 1;
+            if (!readVarint(value) || value > UINT16_MAX) {
+                return false;
+            }
+            frame.raw_value[i] = static_cast<uint16_t>(value);
+            if (!readVarint(value) || value > UINT16_MAX) {
+                return false;
+            }
+            frame.filtered_value[i] = static_cast<uint16_t>(value);
+        }
+        return true;
+    }
+    if (tag != TraceRecorder::DELTA_FRAME || !synced) {
+        return false;
+    }
+    frame = last;
+    frame.dropped_before = 0;
+    if (!readVarint(value)) {
+        return false;
+    }
+    frame.timestamp_ms += value;
+    uint16_t pads = frame.pad_mask;
+    while (pads) {
+        const int i = __builtin_ctz(pads);
+        pads &= pads - 1;
+        uint16_t *field[2] = {&frame.raw_value[i], &frame.filtered_value[i]};
+        for (uint16_t *v : field) {
+            if (!readVarint(value)) {
+                return false;
+            }
+            const int32_t delta = static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+            *v = static_cast<uint16_t>(*v + delta);
+        }
+    }
+    return true;
+}
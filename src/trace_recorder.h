@@ -0,0 +1,143 @@
+/** @file trace_recorder.h */
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <driver/touch_pad.h>
+#include <HardwareSerial.h>
+
+/** @brief Bytes buffered by TraceRecorder between the filter callback and
+ *         drain(). Must be a power of two. With all ten pads at the
+ *         default 10 ms filter period and typical noise, a trace takes
+ *         about 2.5 kB/s.
+ */
+#ifndef ESP32TOUCH_TRACE_BUFFER_SIZE
+#define ESP32TOUCH_TRACE_BUFFER_SIZE 2048
+#endif
+
+/************************* TraceRecorder *************************************//**
+ * @brief Compact binary recorder of the raw and filtered touch sensor
+ *        readouts, see ESP32Touch::startTrace()
+ *
+ * record() is called from the touch filter callback. It delta-encodes one
+ * sample into a lock-free byte ring and returns, which takes well below a
+ * microsecond. drain() then writes the buffered bytes to any Print sink,
+ * e.g. Serial or an SD card file, from a task or loop().
+ *
+ * Stream format, all multi-byte integers little-endian:
+ *
+ *     "ETR1"                               magic, written by start()
+ *     frame...
+ *
+ * Frames start with a tag byte:
+ *  - KEY_FRAME: pad mask (u16), timestamp in ms (u32), number of frames
+ *    dropped before this one (varint), then raw and filtered readout
+ *    (varint each) for each pad in the mask, lowest pad first.
+ *  - DELTA_FRAME: timestamp delta (varint), then the raw and filtered
+ *    readout differences to the previous frame (zigzag varint each).
+ *
+ * Varints are LEB128, i.e. 7 bits per byte, low bits first. So a delta
+ * frame of a quiet pad takes two bytes. The first frame after start() and
+ * after frames were dropped because the ring was full is a key frame, so
+ * a trace can be decoded from any key frame on.
+ *
+ * See TraceReader for decoding.
+ */
+class TraceRecorder
+{
+public:
+    static constexpr uint8_t KEY_FRAME = 0x4B;
+    static constexpr uint8_t DELTA_FRAME = 0x44;
+    /** @brief Largest encoded frame in bytes */
+    static constexpr size_t MAX_FRAME_SIZE = 1 + 2 + 4 + 5 + 2 * 3 * TOUCH_PAD_MAX;
+
+    /** @brief Reset and write the stream header. Must not be called while
+     *         record() may run, i.e. while attached to an ESP32Touch.
+     * @param pad_mask Bit n set for each touch pad n to be recorded
+     */
+    void start(const uint16_t pad_mask);
+
+    /** @brief Append one sample. Producer side only, called from the
+     *         touch filter callback.
+     * @param raw_value Raw readout of all TOUCH_PAD_MAX pads
+     * @param filtered_value Filtered readout of all TOUCH_PAD_MAX pads
+     * @return false if the ring was full and the sample was dropped
+     */
+    bool record(const uint16_t *raw_value, const uint16_t *filtered_value,
+                const uint32_t timestamp_ms);
+
+    /** @brief Write all buffered bytes to out. Consumer side only.
+     * @return Number of bytes written
+     */
+    size_t drain(Print &out);
+
+    /** @brief Total number of samples dropped because the ring was full */
+    uint32_t dropped() const {
+        return total_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr uint32_t buffer_size = ESP32TOUCH_TRACE_BUFFER_SIZE;
+    static_assert(buffer_size >= 2 * MAX_FRAME_SIZE
+                  && (buffer_size & (buffer_size - 1)) == 0,
+                  "ESP32TOUCH_TRACE_BUFFER_SIZE must be a power of two");
+
+    uint8_t buffer[buffer_size];
+    std::atomic<uint32_t> write_index{0};
+    std::atomic<uint32_t> read_index{0};
+    std::atomic<uint32_t> total_dropped{0};
+    // Producer state
+    uint16_t pad_mask = 0;
+    bool key_pending = true;
+    uint32_t dropped_since_key = 0;
+    uint32_t last_timestamp_ms = 0;
+    uint16_t last_raw[TOUCH_PAD_MAX] = {};
+    uint16_t last_filtered[TOUCH_PAD_MAX] = {};
+
+    bool write(const uint8_t *data, const size_t size);
+};
+
+/************************** TraceReader **************************************//**
+ * @brief Decoder for the output of TraceRecorder
+ *
+ * Takes the complete recorded stream in memory. Leading bytes up to the
+ * first key frame, e.g. when a serial capture starts mid-stream, are
+ * skipped.
+ */
+class TraceReader
+{
+public:
+    struct Frame
+    {
+        uint32_t timestamp_ms;
+        /** @brief Bit n set for each recorded touch pad n */
+        uint16_t pad_mask;
+        /** @brief Frames lost right before this one */
+        uint32_t dropped_before;
+        /** @brief Readouts indexed by touch pad number, 0 if not recorded */
+        uint16_t raw_value[TOUCH_PAD_MAX];
+        uint16_t filtered_value[TOUCH_PAD_MAX];
+    };
+
+    TraceReader(const uint8_t *data, const size_t size);
+
+    /** @brief Decode the next frame
+     * @return false at the end of the stream or on a truncated frame
+     */
+    bool next(Frame &frame);
+
+private:
+    const uint8_t *data;
+    size_t size;
+    size_t pos = 0;
+    bool synced = false;
+    Frame last = {};
+
+    bool readVarint(uint32_t &value);
+    bool readFixed(uint32_t &value, const int bytes);
+    bool decodeFrame(Frame &frame);
+};
+
+#endif